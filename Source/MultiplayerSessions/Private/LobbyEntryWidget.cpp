@@ -8,6 +8,26 @@
 
 void ULobbyEntryWidget::SetLobbyInfo(const FLobbyInfo& InLobbyInfo)
 {
+	// Same lobby and same host data version, only the measured fields can differ
+	const bool bMetadataUnchanged = InLobbyInfo.DataVersion > 0 &&
+		InLobbyInfo.DataVersion == LobbyInfo.DataVersion &&
+		InLobbyInfo.LobbyId == LobbyInfo.LobbyId &&
+		InLobbyInfo.bIsFriendLobby == LobbyInfo.bIsFriendLobby;
+
+	if (bMetadataUnchanged)
+	{
+		const bool bLiveUnchanged = InLobbyInfo.CurrentPlayerCount == LobbyInfo.CurrentPlayerCount &&
+			InLobbyInfo.MaxPlayerCount == LobbyInfo.MaxPlayerCount &&
+			InLobbyInfo.PingInMs == LobbyInfo.PingInMs;
+
+		LobbyInfo = InLobbyInfo;
+		if (!bLiveUnchanged)
+		{
+			UpdateLiveDisplay();
+		}
+		return;
+	}
+
 	LobbyInfo = InLobbyInfo;
 	UpdateDisplay();
 }
@@ -24,6 +44,11 @@ void ULobbyEntryWidget::NativeConstruct()
 		EntryButton->OnUnhovered.AddDynamic(this, &ThisClass::OnEntryUnhovered);
 	}
 
+	if (FavoriteButton)
+	{
+		FavoriteButton->OnClicked.AddDynamic(this, &ThisClass::OnFavoriteButtonClicked);
+	}
+
 	// Set initial background color
 	if (BackgroundBorder)
 	{
@@ -45,6 +70,11 @@ void ULobbyEntryWidget::NativeDestruct()
 		EntryButton->OnUnhovered.RemoveDynamic(this, &ThisClass::OnEntryUnhovered);
 	}
 
+	if (FavoriteButton)
+	{
+		FavoriteButton->OnClicked.RemoveDynamic(this, &ThisClass::OnFavoriteButtonClicked);
+	}
+
 	Super::NativeDestruct();
 }
 
@@ -54,6 +84,11 @@ void ULobbyEntryWidget::OnEntryButtonClicked()
 	OnEntryClicked.Broadcast(LobbyInfo);
 }
 
+void ULobbyEntryWidget::OnFavoriteButtonClicked()
+{
+	OnFavoriteClicked.Broadcast(LobbyInfo);
+}
+
 void ULobbyEntryWidget::OnEntryHovered()
 {
 	if (BackgroundBorder)
@@ -79,6 +114,29 @@ void ULobbyEntryWidget::UpdateDisplay()
 		HostNameText->SetText(FText::FromString(LobbyInfo.HostName));
 	}
 
+	UpdateLiveDisplay();
+
+	// Show/hide lock icon based on visibility
+	if (LockIcon)
+	{
+		LockIcon->SetVisibility(LobbyInfo.bIsPublic ? ESlateVisibility::Collapsed : ESlateVisibility::Visible);
+	}
+
+	if (FriendIcon)
+	{
+		FriendIcon->SetVisibility(LobbyInfo.bIsFriendLobby ? ESlateVisibility::Visible : ESlateVisibility::Collapsed);
+	}
+
+	// Update background color based on public/private
+	if (BackgroundBorder)
+	{
+		FLinearColor ColorToUse = LobbyInfo.bIsPublic ? NormalColor : PrivateLobbyColor;
+		BackgroundBorder->SetBrushColor(ColorToUse);
+	}
+}
+
+void ULobbyEntryWidget::UpdateLiveDisplay()
+{
 	// Update player count (e.g., "3/5")
 	if (PlayerCountText)
 	{
@@ -101,17 +159,4 @@ void ULobbyEntryWidget::UpdateDisplay()
 			PingText->SetText(FText::FromString(TEXT("N/A")));
 		}
 	}
-
-	// Show/hide lock icon based on visibility
-	if (LockIcon)
-	{
-		LockIcon->SetVisibility(LobbyInfo.bIsPublic ? ESlateVisibility::Collapsed : ESlateVisibility::Visible);
-	}
-
-	// Update background color based on public/private
-	if (BackgroundBorder)
-	{
-		FLinearColor ColorToUse = LobbyInfo.bIsPublic ? NormalColor : PrivateLobbyColor;
-		BackgroundBorder->SetBrushColor(ColorToUse);
-	}
 }
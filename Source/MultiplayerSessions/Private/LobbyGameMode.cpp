@@ -3,6 +3,8 @@
 #include "LobbyGameMode.h"
 #include "LobbyPlayerState.h"
 #include "LobbyGameState.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "Engine/GameInstance.h"
 #include "GameFramework/PlayerState.h"
 #include "GameFramework/GameStateBase.h"
 
@@ -22,6 +24,29 @@ void ALobbyGameMode::BeginPlay()
 	{
 		LobbyGameState->OnPlayerReadyStateChanged.AddDynamic(this, &ALobbyGameMode::OnPlayerReadyStateChanged);
 	}
+
+	UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem = GetMultiplayerSessionsSubsystem();
+	if (!MultiplayerSessionsSubsystem)
+	{
+		return;
+	}
+
+	// Nobody hosts from a menu on a headless server, the lobby map brings its own lobby
+	if (GetNetMode() == NM_DedicatedServer && bHostLobbyOnDedicatedServer &&
+		!MultiplayerSessionsSubsystem->IsInLobby())
+	{
+		MultiplayerSessionsSubsystem->CreateLobby(DedicatedServerLobbySettings);
+		return;
+	}
+
+	// Back on the lobby map after a match, open the lobby to searches again
+	MultiplayerSessionsSubsystem->ReturnToLobby();
+}
+
+UMultiplayerSessionsSubsystem* ALobbyGameMode::GetMultiplayerSessionsSubsystem() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
 }
 
 void ALobbyGameMode::PostLogin(APlayerController* NewPlayer)
@@ -65,7 +90,7 @@ void ALobbyGameMode::PostLogin(APlayerController* NewPlayer)
 
 void ALobbyGameMode::Logout(AController* ExitingPlayer)
 {
-	APlayerState* PS = ExitingPlayer->GetPlayerState<APlayerState>();
+	APlayerState* PS = ExitingPlayer ? ExitingPlayer->GetPlayerState<APlayerState>() : nullptr;
 	if (PS && GEngine)
 	{
 		FString PlayerName = PS->GetPlayerName();
@@ -205,8 +230,19 @@ bool ALobbyGameMode::StartGame(const FString& GameLevelPath)
 			);
 		}
 
+		// Close the lobby before anyone else can find it mid-travel
+		UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem = GetMultiplayerSessionsSubsystem();
+		if (MultiplayerSessionsSubsystem)
+		{
+			MultiplayerSessionsSubsystem->BeginMatch();
+		}
+
 		// Server travel takes all connected clients to the new level
 		bool bSuccess = World->ServerTravel(GameLevelPath);
+		if (!bSuccess && MultiplayerSessionsSubsystem)
+		{
+			MultiplayerSessionsSubsystem->ReturnToLobby();
+		}
 		return bSuccess;
 	}
 
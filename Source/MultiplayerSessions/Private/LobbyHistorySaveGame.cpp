@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbyHistorySaveGame.h"
+
+void ULobbyHistorySaveGame::RecordJoin(const FLobbyInfo& LobbyInfo, int32 MaxRecent)
+{
+	FLobbyHistoryEntry Entry;
+	const int32 ExistingIndex = Entries.IndexOfByPredicate([&LobbyInfo](const FLobbyHistoryEntry& Existing)
+	{
+		return Existing.LobbyInfo.LobbyId == LobbyInfo.LobbyId;
+	});
+	if (ExistingIndex != INDEX_NONE)
+	{
+		Entry = Entries[ExistingIndex];
+		Entries.RemoveAt(ExistingIndex);
+	}
+
+	Entry.LobbyInfo = LobbyInfo;
+	Entry.LastJoinedTime = FDateTime::UtcNow();
+	Entry.bIsListed = true;
+	Entries.Insert(Entry, 0);
+
+	Trim(MaxRecent);
+}
+
+bool ULobbyHistorySaveGame::SetFavorite(const FLobbyInfo& LobbyInfo, bool bIsFavorite, int32 MaxRecent)
+{
+	FLobbyHistoryEntry* Entry = FindEntry(LobbyInfo.LobbyId);
+	if (!Entry)
+	{
+		if (!bIsFavorite)
+		{
+			return false;
+		}
+
+		// Favorited from the browser without joining, listed after the joined lobbies
+		Entry = &Entries.AddDefaulted_GetRef();
+		Entry->LobbyInfo = LobbyInfo;
+		Entry->bIsListed = true;
+	}
+
+	if (Entry->bIsFavorite == bIsFavorite)
+	{
+		return false;
+	}
+
+	Entry->bIsFavorite = bIsFavorite;
+	Trim(MaxRecent);
+	return true;
+}
+
+FLobbyHistoryEntry* ULobbyHistorySaveGame::FindEntry(const FString& LobbyId)
+{
+	return Entries.FindByPredicate([&LobbyId](const FLobbyHistoryEntry& Entry)
+	{
+		return Entry.LobbyInfo.LobbyId == LobbyId;
+	});
+}
+
+bool ULobbyHistorySaveGame::ApplySearchResult(const TArray<FLobbyInfo>& Lobbies, bool& bOutInfoChanged)
+{
+	bOutInfoChanged = false;
+	if (Entries.Num() == 0)
+	{
+		return false;
+	}
+
+	TMap<FString, const FLobbyInfo*> LobbiesById;
+	TMap<FString, const FLobbyInfo*> LobbiesByHost;
+	LobbiesById.Reserve(Lobbies.Num());
+	LobbiesByHost.Reserve(Lobbies.Num());
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		LobbiesById.Add(Lobby.LobbyId, &Lobby);
+		if (!Lobby.HostId.IsEmpty())
+		{
+			LobbiesByHost.Add(Lobby.HostId, &Lobby);
+		}
+	}
+
+	bool bChanged = false;
+	for (FLobbyHistoryEntry& Entry : Entries)
+	{
+		const FLobbyInfo* const* Found = LobbiesById.Find(Entry.LobbyInfo.LobbyId);
+		if (!Found && !Entry.LobbyInfo.HostId.IsEmpty())
+		{
+			Found = LobbiesByHost.Find(Entry.LobbyInfo.HostId);
+		}
+
+		const bool bIsListed = Found != nullptr;
+		if (Entry.bIsListed != bIsListed)
+		{
+			Entry.bIsListed = bIsListed;
+			bChanged = true;
+		}
+
+		if (Found && (Entry.LobbyInfo.LobbyId != (*Found)->LobbyId || Entry.LobbyInfo.DiffersFrom(**Found)))
+		{
+			Entry.LobbyInfo = **Found;
+			bChanged = true;
+			bOutInfoChanged = true;
+		}
+	}
+
+	return bChanged;
+}
+
+void ULobbyHistorySaveGame::Trim(int32 MaxRecent)
+{
+	int32 RecentCount = 0;
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		if (Entries[Index].bIsFavorite)
+		{
+			continue;
+		}
+
+		if (++RecentCount > MaxRecent)
+		{
+			Entries.RemoveAt(Index--);
+		}
+	}
+}
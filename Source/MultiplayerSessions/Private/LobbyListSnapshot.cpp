@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbyListSnapshot.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	/** "LLS1", tells snapshots apart from whatever else may end up at the path */
+	constexpr uint32 SnapshotMagic = 0x4C4C5331;
+
+	/** Sanity bound against corrupt counts, far above any MaxSearchResults */
+	constexpr int32 MaxSnapshotLobbies = 10000;
+
+	void SerializeLobby(FArchive& Ar, FLobbyInfo& Lobby)
+	{
+		Ar << Lobby.LobbyId;
+		Ar << Lobby.HostName;
+		Ar << Lobby.CurrentPlayerCount;
+		Ar << Lobby.MaxPlayerCount;
+		Ar << Lobby.bIsPublic;
+		Ar << Lobby.PingInMs;
+		Ar << Lobby.GameMode;
+		Ar << Lobby.Region;
+		Ar << Lobby.BuildVersion;
+		Ar << Lobby.DataVersion;
+		Ar << Lobby.bIsFriendLobby;
+	}
+}
+
+FString FLobbyListSnapshot::GetDefaultPath()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MultiplayerSessions"), TEXT("LobbyListSnapshot.bin"));
+}
+
+bool FLobbyListSnapshot::SaveToFile(const FString& Path) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = SnapshotMagic;
+	uint32 Version = FormatVersion;
+	int64 Ticks = Timestamp.GetTicks();
+	int32 Count = Lobbies.Num();
+
+	Writer << Magic;
+	Writer << Version;
+	Writer << Ticks;
+	Writer << Count;
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		SerializeLobby(Writer, const_cast<FLobbyInfo&>(Lobby));
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FLobbyListSnapshot::LoadFromFile(const FString& Path)
+{
+	// A few kilobytes, one read is all it takes
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int64 Ticks = 0;
+	int32 Count = 0;
+
+	Reader << Magic;
+	Reader << Version;
+	if (Reader.IsError() || Magic != SnapshotMagic || Version != FormatVersion)
+	{
+		return false;
+	}
+
+	Reader << Ticks;
+	Reader << Count;
+	if (Reader.IsError() || Count < 0 || Count > MaxSnapshotLobbies)
+	{
+		return false;
+	}
+
+	TArray<FLobbyInfo> LoadedLobbies;
+	LoadedLobbies.SetNum(Count);
+	for (FLobbyInfo& Lobby : LoadedLobbies)
+	{
+		SerializeLobby(Reader, Lobby);
+	}
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	Timestamp = FDateTime(Ticks);
+	Lobbies = MoveTemp(LoadedLobbies);
+	return true;
+}
@@ -8,6 +8,7 @@
 #include "Components/Button.h"
 #include "Components/TextBlock.h"
 #include "Components/Widget.h"
+#include "Algo/StableSort.h"
 
 void ULobbyListWidget::Setup(UMultiplayerSessionsSubsystem* Subsystem)
 {
@@ -15,7 +16,17 @@ void ULobbyListWidget::Setup(UMultiplayerSessionsSubsystem* Subsystem)
 
 	if (SessionsSubsystem)
 	{
-		SessionsSubsystem->MultiplayerOnLobbyListUpdated.AddDynamic(this, &ThisClass::OnLobbyListUpdated);
+		SessionsSubsystem->MultiplayerOnLobbyListChanged.AddDynamic(this, &ThisClass::OnLobbyListChanged);
+		SessionsSubsystem->MultiplayerOnLobbyPageReceived.AddDynamic(this, &ThisClass::OnLobbyPageReceived);
+		SessionsSubsystem->MultiplayerOnLobbyHistoryUpdated.AddDynamic(this, &ThisClass::OnLobbyHistoryUpdated);
+
+		// Loaded from disk, available before any search
+		PopulateRecentLobbies(SessionsSubsystem->GetLobbyHistory());
+		if (!bUsePagedSearch)
+		{
+			PopulateLobbyList(SessionsSubsystem->GetLastLobbyList());
+			ShowStaleLobbyList();
+		}
 	}
 }
 
@@ -34,6 +45,11 @@ void ULobbyListWidget::NativeConstruct()
 		BackButton->OnClicked.AddDynamic(this, &ThisClass::OnBackButtonClicked);
 	}
 
+	if (LobbyScrollBox)
+	{
+		LobbyScrollBox->OnUserScrolled.AddDynamic(this, &ThisClass::OnLobbyListScrolled);
+	}
+
 	// Initialize UI state
 	SetLoadingState(false);
 	UpdateStatusText(0);
@@ -49,7 +65,11 @@ void ULobbyListWidget::NativeDestruct()
 	// Unbind subsystem delegate
 	if (SessionsSubsystem)
 	{
-		SessionsSubsystem->MultiplayerOnLobbyListUpdated.RemoveDynamic(this, &ThisClass::OnLobbyListUpdated);
+		SetBrowsingActive(false);
+		SessionsSubsystem->CancelFindLobbies();
+		SessionsSubsystem->MultiplayerOnLobbyListChanged.RemoveDynamic(this, &ThisClass::OnLobbyListChanged);
+		SessionsSubsystem->MultiplayerOnLobbyPageReceived.RemoveDynamic(this, &ThisClass::OnLobbyPageReceived);
+		SessionsSubsystem->MultiplayerOnLobbyHistoryUpdated.RemoveDynamic(this, &ThisClass::OnLobbyHistoryUpdated);
 	}
 
 	// Unbind button callbacks
@@ -63,8 +83,14 @@ void ULobbyListWidget::NativeDestruct()
 		BackButton->OnClicked.RemoveDynamic(this, &ThisClass::OnBackButtonClicked);
 	}
 
+	if (LobbyScrollBox)
+	{
+		LobbyScrollBox->OnUserScrolled.RemoveDynamic(this, &ThisClass::OnLobbyListScrolled);
+	}
+
 	// Clean up lobby entry widgets
 	ClearLobbyList();
+	ClearRecentLobbies();
 
 	Super::NativeDestruct();
 }
@@ -77,9 +103,50 @@ void ULobbyListWidget::RefreshLobbyList()
 	}
 
 	SetLoadingState(true);
-	ClearLobbyList();
 
-	SessionsSubsystem->FindLobbies(MaxSearchResults);
+	if (bUsePagedSearch)
+	{
+		ClearLobbyList();
+		bIsLoadingPage = true;
+		bHasMorePages = false;
+		SessionsSubsystem->FindLobbiesPaged(LobbyPageSize, SearchFilter);
+	}
+	else
+	{
+		// Diffs are relative to the subsystem's last list, catch up with it first
+		PopulateLobbyList(SessionsSubsystem->GetLastLobbyList());
+		ShowStaleLobbyList();
+		if (bUseSearchPlan)
+		{
+			SessionsSubsystem->FindLobbiesWithPlan(SearchPlan);
+		}
+		else
+		{
+			SessionsSubsystem->FindLobbies(MaxSearchResults, SearchFilter);
+		}
+		if (bIncludeFriendLobbies)
+		{
+			SessionsSubsystem->FindFriendLobbies();
+		}
+	}
+}
+
+void ULobbyListWidget::SetBrowsingActive(bool bActive)
+{
+	if (!SessionsSubsystem)
+	{
+		return;
+	}
+
+	// Paged lists grow on demand, they are not refreshed in the background
+	if (bActive && !bUsePagedSearch)
+	{
+		SessionsSubsystem->StartLobbyBrowsing(MaxSearchResults, SearchFilter);
+	}
+	else if (SessionsSubsystem->IsBrowsingLobbies())
+	{
+		SessionsSubsystem->StopLobbyBrowsing();
+	}
 }
 
 void ULobbyListWidget::OnRefreshButtonClicked()
@@ -89,29 +156,49 @@ void ULobbyListWidget::OnRefreshButtonClicked()
 
 void ULobbyListWidget::OnBackButtonClicked()
 {
+	// Nobody is waiting for the results anymore
+	if (SessionsSubsystem)
+	{
+		SessionsSubsystem->CancelFindLobbies();
+	}
+	SetLoadingState(false);
+	bIsLoadingPage = false;
+
 	OnBackButtonPressed.Broadcast();
 }
 
-void ULobbyListWidget::OnLobbyListUpdated(const TArray<FLobbyInfo>& Lobbies, bool bWasSuccessful)
+void ULobbyListWidget::OnLobbyListChanged(const FLobbyListDiff& Diff, bool bWasSuccessful)
 {
+	// Paged mode appends batches from OnLobbyPageReceived instead
+	if (bUsePagedSearch)
+	{
+		return;
+	}
+
 	SetLoadingState(false);
 
 	if (bWasSuccessful)
 	{
-		PopulateLobbyList(Lobbies);
-		UpdateStatusText(Lobbies.Num());
+		// The diff carries no order, the subsystem's list is already the new one
+		ApplyLobbyListDiff(Diff);
+		if (SessionsSubsystem)
+		{
+			MatchLobbyListOrder(SessionsSubsystem->GetLastLobbyList());
+		}
+		UpdateStatusText(LobbyEntryWidgets.Num());
 
 		// Show/hide empty state
 		if (EmptyStateText)
 		{
-			EmptyStateText->SetVisibility(Lobbies.Num() == 0 ? ESlateVisibility::Visible : ESlateVisibility::Collapsed);
+			EmptyStateText->SetVisibility(LobbyEntryWidgets.Num() == 0
+				                              ? ESlateVisibility::Visible
+				                              : ESlateVisibility::Collapsed);
 		}
 	}
 	else
 	{
-		// Show error state
-		ClearLobbyList();
-		UpdateStatusText(0);
+		// Show error state, the last known lobbies stay listed
+		UpdateStatusText(LobbyEntryWidgets.Num());
 		if (StatusText)
 		{
 			StatusText->SetText(FText::FromString(TEXT("Failed to find lobbies")));
@@ -119,39 +206,320 @@ void ULobbyListWidget::OnLobbyListUpdated(const TArray<FLobbyInfo>& Lobbies, boo
 	}
 }
 
+void ULobbyListWidget::OnLobbyPageReceived(const TArray<FLobbyInfo>& Lobbies, bool bInHasMorePages,
+                                           bool bWasSuccessful)
+{
+	if (!bUsePagedSearch)
+	{
+		return;
+	}
+
+	// Batches are already deduplicated by the subsystem, just append them
+	SetLoadingState(false);
+	bIsLoadingPage = false;
+	bHasMorePages = bInHasMorePages;
+
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		AddLobbyEntry(Lobby);
+	}
+
+	UpdateStatusText(LobbyEntryWidgets.Num());
+
+	if (EmptyStateText)
+	{
+		EmptyStateText->SetVisibility(LobbyEntryWidgets.Num() == 0 && !bHasMorePages
+			                              ? ESlateVisibility::Visible
+			                              : ESlateVisibility::Collapsed);
+	}
+
+	if (!bWasSuccessful && LobbyEntryWidgets.Num() == 0 && StatusText)
+	{
+		StatusText->SetText(FText::FromString(TEXT("Failed to find lobbies")));
+	}
+}
+
+void ULobbyListWidget::OnLobbyListScrolled(float CurrentOffset)
+{
+	if (!bUsePagedSearch || !SessionsSubsystem || !LobbyScrollBox || bIsLoadingPage || !bHasMorePages)
+	{
+		return;
+	}
+
+	if (CurrentOffset >= LobbyScrollBox->GetScrollOffsetOfEnd() - NextPageScrollThreshold)
+	{
+		bIsLoadingPage = true;
+		SessionsSubsystem->RequestNextLobbyPage();
+	}
+}
+
 void ULobbyListWidget::OnLobbyEntryClicked(const FLobbyInfo& LobbyInfo)
 {
 	// Boradcast to parent (Menu) that a lobby was selected
 	OnLobbySelected.Broadcast(LobbyInfo);
 }
 
-void ULobbyListWidget::PopulateLobbyList(const TArray<FLobbyInfo>& Lobbies)
+void ULobbyListWidget::OnLobbyEntryFavoriteClicked(const FLobbyInfo& LobbyInfo)
 {
-	ClearLobbyList();
+	if (SessionsSubsystem)
+	{
+		SessionsSubsystem->SetLobbyFavorite(LobbyInfo, !SessionsSubsystem->IsLobbyFavorite(LobbyInfo.LobbyId));
+	}
+}
 
-	if (!LobbyScrollBox || !LobbyEntryWidgetClass)
+void ULobbyListWidget::OnLobbyHistoryUpdated(const TArray<FLobbyHistoryEntry>& History)
+{
+	PopulateRecentLobbies(History);
+}
+
+void ULobbyListWidget::PopulateRecentLobbies(const TArray<FLobbyHistoryEntry>& History)
+{
+	if (!RecentLobbyScrollBox || !LobbyEntryWidgetClass)
 	{
 		return;
 	}
 
-	for (const FLobbyInfo& Lobby : Lobbies)
+	// Only a handful of entries, rebuilt as a whole
+	ClearRecentLobbies();
+
+	for (const FLobbyHistoryEntry& Entry : History)
 	{
-		// Create lobby entry widget
 		ULobbyEntryWidget* EntryWidget = CreateWidget<ULobbyEntryWidget>(this, LobbyEntryWidgetClass);
+		if (!EntryWidget)
+		{
+			continue;
+		}
+
+		// Clicking an unlisted lobby still tries it, the join resolves it by id
+		EntryWidget->SetLobbyInfo(Entry.LobbyInfo);
+		EntryWidget->SetRenderOpacity(Entry.bIsListed ? 1.f : UnlistedRecentLobbyOpacity);
+		EntryWidget->OnEntryClicked.AddDynamic(this, &ThisClass::OnLobbyEntryClicked);
+		EntryWidget->OnFavoriteClicked.AddDynamic(this, &ThisClass::OnLobbyEntryFavoriteClicked);
+
+		RecentLobbyScrollBox->AddChild(EntryWidget);
+		RecentLobbyEntryWidgets.Add(EntryWidget);
+	}
+}
+
+void ULobbyListWidget::ClearRecentLobbies()
+{
+	if (RecentLobbyScrollBox)
+	{
+		RecentLobbyScrollBox->ClearChildren();
+	}
+
+	for (ULobbyEntryWidget* EntryWidget : RecentLobbyEntryWidgets)
+	{
 		if (EntryWidget)
 		{
-			// Set lobby data
-			EntryWidget->SetLobbyInfo(Lobby);
+			EntryWidget->OnEntryClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryClicked);
+			EntryWidget->OnFavoriteClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryFavoriteClicked);
+		}
+	}
 
-			// Bind click callback
-			EntryWidget->OnEntryClicked.AddDynamic(this, &ThisClass::OnLobbyEntryClicked);
+	RecentLobbyEntryWidgets.Empty();
+}
+
+void ULobbyListWidget::PopulateLobbyList(const TArray<FLobbyInfo>& Lobbies)
+{
+	if (!LobbyScrollBox || !LobbyEntryWidgetClass)
+	{
+		ClearLobbyList();
+		return;
+	}
 
-			// Add to scroll box
+	TMap<FString, const FLobbyInfo*> PendingLobbies;
+	PendingLobbies.Reserve(Lobbies.Num());
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		PendingLobbies.Add(Lobby.LobbyId, &Lobby);
+	}
+
+	// Keep the rows of lobbies still listed, they skip redrawing if nothing changed
+	for (int32 Index = LobbyEntryWidgets.Num() - 1; Index >= 0; --Index)
+	{
+		ULobbyEntryWidget* EntryWidget = LobbyEntryWidgets[Index];
+		const FString LobbyId = EntryWidget ? EntryWidget->GetLobbyInfo().LobbyId : FString();
+
+		const FLobbyInfo* const* Lobby = EntryWidget ? PendingLobbies.Find(LobbyId) : nullptr;
+		if (!Lobby)
+		{
+			RemoveLobbyEntryAt(Index);
+			continue;
+		}
+
+		EntryWidget->SetLobbyInfo(**Lobby);
+		PendingLobbies.Remove(LobbyId);
+	}
+
+	// New lobbies go to the end, in search order
+	LobbyEntryWidgets.Reserve(Lobbies.Num());
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		if (PendingLobbies.Contains(Lobby.LobbyId))
+		{
+			AddLobbyEntry(Lobby);
+		}
+	}
+
+	MatchLobbyListOrder(Lobbies);
+}
+
+void ULobbyListWidget::MatchLobbyListOrder(const TArray<FLobbyInfo>& Lobbies)
+{
+	if (!LobbyScrollBox)
+	{
+		return;
+	}
+
+	TMap<FString, int32> ListIndices;
+	ListIndices.Reserve(Lobbies.Num());
+	for (int32 Index = 0; Index < Lobbies.Num(); ++Index)
+	{
+		ListIndices.Add(Lobbies[Index].LobbyId, Index);
+	}
+
+	// Rows the list does not know about stay at the end
+	auto GetListIndex = [&ListIndices](const ULobbyEntryWidget* EntryWidget)
+	{
+		const int32* Index = EntryWidget ? ListIndices.Find(EntryWidget->GetLobbyInfo().LobbyId) : nullptr;
+		return Index ? *Index : MAX_int32;
+	};
+
+	bool bInOrder = true;
+	for (int32 Index = 1; Index < LobbyEntryWidgets.Num() && bInOrder; ++Index)
+	{
+		bInOrder = GetListIndex(LobbyEntryWidgets[Index - 1]) <= GetListIndex(LobbyEntryWidgets[Index]);
+	}
+	if (bInOrder)
+	{
+		return;
+	}
+
+	// Like the recent lobbies the rows are re-added as a whole, but the widgets themselves are kept
+	Algo::StableSortBy(LobbyEntryWidgets, GetListIndex);
+
+	LobbyScrollBox->ClearChildren();
+	for (ULobbyEntryWidget* EntryWidget : LobbyEntryWidgets)
+	{
+		if (EntryWidget)
+		{
 			LobbyScrollBox->AddChild(EntryWidget);
+		}
+	}
+}
 
-			// Store reference
+void ULobbyListWidget::ApplyLobbyListDiff(const FLobbyListDiff& Diff)
+{
+	if (!LobbyScrollBox || !LobbyEntryWidgetClass)
+	{
+		return;
+	}
+
+	// Removals first, the remaining rows keep their place and the scroll position
+	if (Diff.RemovedLobbyIds.Num() > 0)
+	{
+		const TSet<FString> RemovedLobbyIds(Diff.RemovedLobbyIds);
+		for (int32 Index = LobbyEntryWidgets.Num() - 1; Index >= 0; --Index)
+		{
+			ULobbyEntryWidget* EntryWidget = LobbyEntryWidgets[Index];
+			if (!EntryWidget || RemovedLobbyIds.Contains(EntryWidget->GetLobbyInfo().LobbyId))
+			{
+				RemoveLobbyEntryAt(Index);
+			}
+		}
+	}
+
+	if (Diff.Changed.Num() == 0 && Diff.Added.Num() == 0)
+	{
+		return;
+	}
+
+	TMap<FString, ULobbyEntryWidget*> EntriesById;
+	EntriesById.Reserve(LobbyEntryWidgets.Num());
+	for (ULobbyEntryWidget* EntryWidget : LobbyEntryWidgets)
+	{
+		if (EntryWidget)
+		{
+			EntriesById.Add(EntryWidget->GetLobbyInfo().LobbyId, EntryWidget);
+		}
+	}
+
+	// Friend lobbies lead the list, new ones go in after the friend rows already shown
+	int32 FriendRowCount = 0;
+	while (FriendRowCount < LobbyEntryWidgets.Num() && LobbyEntryWidgets[FriendRowCount] &&
+		LobbyEntryWidgets[FriendRowCount]->GetLobbyInfo().bIsFriendLobby)
+	{
+		++FriendRowCount;
+	}
+
+	// Tolerate rows the widget missed (e.g. created after the previous diff)
+	auto UpsertLobbyEntry = [this, &EntriesById, &FriendRowCount](const FLobbyInfo& Lobby)
+	{
+		if (ULobbyEntryWidget** EntryWidget = EntriesById.Find(Lobby.LobbyId))
+		{
+			(*EntryWidget)->SetLobbyInfo(Lobby);
+		}
+		else if (Lobby.bIsFriendLobby)
+		{
+			AddLobbyEntry(Lobby, FriendRowCount++);
+		}
+		else
+		{
+			AddLobbyEntry(Lobby);
+		}
+	};
+
+	for (const FLobbyInfo& Lobby : Diff.Changed)
+	{
+		UpsertLobbyEntry(Lobby);
+	}
+	for (const FLobbyInfo& Lobby : Diff.Added)
+	{
+		UpsertLobbyEntry(Lobby);
+	}
+}
+
+void ULobbyListWidget::RemoveLobbyEntryAt(int32 Index)
+{
+	if (ULobbyEntryWidget* EntryWidget = LobbyEntryWidgets[Index])
+	{
+		EntryWidget->OnEntryClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryClicked);
+		EntryWidget->OnFavoriteClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryFavoriteClicked);
+		EntryWidget->RemoveFromParent();
+	}
+	LobbyEntryWidgets.RemoveAt(Index);
+}
+
+void ULobbyListWidget::AddLobbyEntry(const FLobbyInfo& Lobby, int32 Index)
+{
+	if (!LobbyScrollBox || !LobbyEntryWidgetClass)
+	{
+		return;
+	}
+
+	// Create lobby entry widget
+	ULobbyEntryWidget* EntryWidget = CreateWidget<ULobbyEntryWidget>(this, LobbyEntryWidgetClass);
+	if (EntryWidget)
+	{
+		// Set lobby data
+		EntryWidget->SetLobbyInfo(Lobby);
+
+		// Bind click callback
+		EntryWidget->OnEntryClicked.AddDynamic(this, &ThisClass::OnLobbyEntryClicked);
+		EntryWidget->OnFavoriteClicked.AddDynamic(this, &ThisClass::OnLobbyEntryFavoriteClicked);
+
+		// Add to scroll box, in place so the other rows and the scroll position stay
+		if (Index == INDEX_NONE || Index >= LobbyEntryWidgets.Num())
+		{
+			LobbyScrollBox->AddChild(EntryWidget);
 			LobbyEntryWidgets.Add(EntryWidget);
 		}
+		else
+		{
+			LobbyScrollBox->InsertChildAt(Index, EntryWidget);
+			LobbyEntryWidgets.Insert(EntryWidget, Index);
+		}
 	}
 }
 
@@ -168,6 +536,7 @@ void ULobbyListWidget::ClearLobbyList()
 		if (EntryWidget)
 		{
 			EntryWidget->OnEntryClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryClicked);
+			EntryWidget->OnFavoriteClicked.RemoveDynamic(this, &ThisClass::OnLobbyEntryFavoriteClicked);
 		}
 	}
 
@@ -192,6 +561,28 @@ void ULobbyListWidget::SetLoadingState(bool bIsLoading)
 	}
 }
 
+void ULobbyListWidget::ShowStaleLobbyList()
+{
+	if (!SessionsSubsystem || !SessionsSubsystem->IsLobbyListStale() || LobbyEntryWidgets.Num() == 0)
+	{
+		return;
+	}
+
+	// Lobbies from the last run stay visible while the search replaces them
+	if (LobbyScrollBox)
+	{
+		LobbyScrollBox->SetVisibility(ESlateVisibility::Visible);
+	}
+
+	if (StatusText)
+	{
+		const FTimespan Age = FDateTime::UtcNow() - SessionsSubsystem->GetLobbyListTimestamp();
+		StatusText->SetText(FText::FromString(
+			FString::Printf(TEXT("%d lobbies from %d min ago, refreshing..."),
+			                LobbyEntryWidgets.Num(), FMath::Max(0, static_cast<int32>(Age.GetTotalMinutes())))));
+	}
+}
+
 void ULobbyListWidget::UpdateStatusText(int32 LobbyCount)
 {
 	if (StatusText)
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbyMetadataCodec.h"
+
+#include "OnlineSessionSettings.h"
+#include "LobbyAttributes.h"
+#include "Misc/Base64.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	enum ELobbyMetadataFlags : uint8
+	{
+		LobbyMetadata_Public = 1 << 0
+	};
+
+	/** Version, flags and build version */
+	constexpr int64 PackedHeaderSize = sizeof(uint8) + sizeof(uint8) + sizeof(uint32);
+
+	/** Strings are UTF-8 with a single length byte */
+	constexpr int32 MaxPackedStringLength = 255;
+
+	void WriteString(FArchive& Writer, const FString& Value)
+	{
+		const FTCHARToUTF8 Utf8(*Value);
+		int32 Length = FMath::Min(Utf8.Length(), MaxPackedStringLength);
+
+		// Never cut a multi-byte character in half
+		while (Length > 0 && Length < Utf8.Length() && (Utf8.Get()[Length] & 0xC0) == 0x80)
+		{
+			--Length;
+		}
+
+		uint8 PackedLength = static_cast<uint8>(Length);
+		Writer << PackedLength;
+		Writer.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Length);
+	}
+
+	bool ReadString(FArchive& Reader, FString& OutValue)
+	{
+		if (Reader.AtEnd())
+		{
+			return false;
+		}
+
+		uint8 Length = 0;
+		Reader << Length;
+		if (Reader.Tell() + Length > Reader.TotalSize())
+		{
+			return false;
+		}
+
+		ANSICHAR Buffer[MaxPackedStringLength];
+		Reader.Serialize(Buffer, Length);
+
+		const FUTF8ToTCHAR Converted(Buffer, Length);
+		OutValue = FString(Converted.Length(), Converted.Get());
+		return true;
+	}
+}
+
+void FLobbyMetadataCodec::Write(FOnlineSessionSettings& Settings, const FLobbyInfo& Info, bool bPacked)
+{
+	// Backend filters need this as its own key in both layouts
+	LobbyAttributes::FIsPublic::Set(Settings, Info.bIsPublic);
+
+	if (bPacked)
+	{
+		LobbyAttributes::FPackedMetadata::Set(Settings, Encode(Info));
+		LobbyAttributes::FHostName::Remove(Settings);
+		LobbyAttributes::FGameMode::Remove(Settings);
+		LobbyAttributes::FRegion::Remove(Settings);
+		LobbyAttributes::FBuildVersion::Remove(Settings);
+		return;
+	}
+
+	LobbyAttributes::FPackedMetadata::Remove(Settings);
+	LobbyAttributes::FHostName::Set(Settings, Info.HostName);
+	LobbyAttributes::FBuildVersion::Set(Settings, Info.BuildVersion);
+
+	// Optional fields are only advertised when set
+	if (Info.GameMode.IsEmpty())
+	{
+		LobbyAttributes::FGameMode::Remove(Settings);
+	}
+	else
+	{
+		LobbyAttributes::FGameMode::Set(Settings, Info.GameMode);
+	}
+
+	if (Info.Region.IsEmpty())
+	{
+		LobbyAttributes::FRegion::Remove(Settings);
+	}
+	else
+	{
+		LobbyAttributes::FRegion::Set(Settings, Info.Region);
+	}
+}
+
+void FLobbyMetadataCodec::Read(const FOnlineSessionSettings& Settings, FLobbyInfo& OutInfo)
+{
+	LobbyAttributes::FIsPublic::Get(Settings, OutInfo.bIsPublic);
+	LobbyAttributes::FDataVersion::Get(Settings, OutInfo.DataVersion);
+
+	FString Packed;
+	if (LobbyAttributes::FPackedMetadata::Get(Settings, Packed))
+	{
+		if (Decode(Packed, OutInfo))
+		{
+			return;
+		}
+		UE_LOG(LogTemp, Warning, TEXT("Ignoring malformed packed lobby metadata"));
+	}
+
+	LobbyAttributes::FHostName::Get(Settings, OutInfo.HostName);
+	LobbyAttributes::FGameMode::Get(Settings, OutInfo.GameMode);
+	LobbyAttributes::FRegion::Get(Settings, OutInfo.Region);
+	LobbyAttributes::FBuildVersion::Get(Settings, OutInfo.BuildVersion);
+}
+
+void FLobbyMetadataCodec::BumpDataVersion(FOnlineSessionSettings& Settings)
+{
+	int32 DataVersion = 0;
+	LobbyAttributes::FDataVersion::Get(Settings, DataVersion);
+	LobbyAttributes::FDataVersion::Set(Settings, DataVersion + 1);
+}
+
+FString FLobbyMetadataCodec::Encode(const FLobbyInfo& Info)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint8 Version = PackedVersion;
+	uint8 Flags = Info.bIsPublic ? LobbyMetadata_Public : 0;
+	uint32 BuildVersion = static_cast<uint32>(Info.BuildVersion);
+
+	Writer << Version;
+	Writer << Flags;
+	Writer << BuildVersion;
+	WriteString(Writer, Info.HostName);
+	WriteString(Writer, Info.GameMode);
+	WriteString(Writer, Info.Region);
+
+	return FBase64::Encode(Bytes);
+}
+
+bool FLobbyMetadataCodec::Decode(const FString& Packed, FLobbyInfo& OutInfo)
+{
+	TArray<uint8> Bytes;
+	if (!FBase64::Decode(Packed, Bytes) || Bytes.Num() < PackedHeaderSize)
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint8 Version = 0;
+	uint8 Flags = 0;
+	uint32 BuildVersion = 0;
+	Reader << Version;
+	Reader << Flags;
+	Reader << BuildVersion;
+
+	if (Version == 0)
+	{
+		return false;
+	}
+
+	// Version 1 fields, anything a newer host appended after them is ignored
+	FString HostName;
+	FString GameMode;
+	FString Region;
+	if (!ReadString(Reader, HostName) || !ReadString(Reader, GameMode) || !ReadString(Reader, Region))
+	{
+		return false;
+	}
+
+	OutInfo.bIsPublic = (Flags & LobbyMetadata_Public) != 0;
+	OutInfo.BuildVersion = static_cast<int32>(BuildVersion);
+	OutInfo.HostName = MoveTemp(HostName);
+	OutInfo.GameMode = MoveTemp(GameMode);
+	OutInfo.Region = MoveTemp(Region);
+	return true;
+}
@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbyOperationScheduler.h"
+
+namespace
+{
+	// Finished results are mostly looked up by operations queued shortly after,
+	// older ones are only kept while an outstanding operation still depends on them.
+	constexpr uint32 FinishedResultWindow = 64;
+}
+
+FLobbyOperationId FLobbyOperationScheduler::Enqueue(FLobbyOperation&& Operation)
+{
+	TSharedRef<FLobbyOperation> NewOperation = MakeShared<FLobbyOperation>(MoveTemp(Operation));
+	NewOperation->Id = NextOperationId++;
+	NewOperation->State = ELobbyOperationState::Pending;
+
+	// Chain behind any outstanding operation touching the same resource
+	for (const TSharedRef<FLobbyOperation>& Outstanding : Operations)
+	{
+		if (Conflicts(*Outstanding, *NewOperation))
+		{
+			NewOperation->Dependencies.AddUnique(Outstanding->Id);
+		}
+	}
+
+	Operations.Add(NewOperation);
+	const FLobbyOperationId OperationId = NewOperation->Id;
+
+	Pump();
+	return OperationId;
+}
+
+void FLobbyOperationScheduler::Complete(FLobbyOperationId OperationId, bool bWasSuccessful, int32 ResultCode)
+{
+	const TSharedRef<FLobbyOperation>* Found = Operations.FindByPredicate(
+		[OperationId](const TSharedRef<FLobbyOperation>& Operation) { return Operation->Id == OperationId; });
+
+	if (!Found || (*Found)->State != ELobbyOperationState::Running)
+	{
+		return;
+	}
+
+	TSharedRef<FLobbyOperation> Operation = *Found;
+	Operation->ResultCode = ResultCode;
+	Finish(Operation, bWasSuccessful ? ELobbyOperationState::Succeeded : ELobbyOperationState::Failed);
+}
+
+void FLobbyOperationScheduler::Reset()
+{
+	TArray<TSharedRef<FLobbyOperation>> Outstanding = MoveTemp(Operations);
+	Operations.Reset();
+
+	for (const TSharedRef<FLobbyOperation>& Operation : Outstanding)
+	{
+		if (Operation->State == ELobbyOperationState::Running && UnbindHandler)
+		{
+			UnbindHandler(*Operation);
+		}
+		Operation->State = ELobbyOperationState::Failed;
+		FinishedResults.Add(Operation->Id, false);
+	}
+}
+
+void FLobbyOperationScheduler::ExpireOperations(double Now)
+{
+	TArray<TSharedRef<FLobbyOperation>> Expired;
+	for (const TSharedRef<FLobbyOperation>& Operation : Operations)
+	{
+		if (Operation->State == ELobbyOperationState::Running && Operation->Deadline > 0.0 && Now >= Operation->Deadline)
+		{
+			Expired.Add(Operation);
+		}
+	}
+
+	for (const TSharedRef<FLobbyOperation>& Operation : Expired)
+	{
+		// Completion handlers of earlier ones may have finished it already
+		if (Operation->State == ELobbyOperationState::Running)
+		{
+			Finish(Operation, ELobbyOperationState::TimedOut);
+		}
+	}
+}
+
+void FLobbyOperationScheduler::Cancel(ELobbyOperationType Type)
+{
+	TArray<TSharedRef<FLobbyOperation>> Cancelled;
+	for (const TSharedRef<FLobbyOperation>& Operation : Operations)
+	{
+		if (Operation->Type == Type)
+		{
+			Cancelled.Add(Operation);
+		}
+	}
+
+	for (const TSharedRef<FLobbyOperation>& Operation : Cancelled)
+	{
+		if (Operation->State == ELobbyOperationState::Pending || Operation->State == ELobbyOperationState::Running)
+		{
+			Finish(Operation, ELobbyOperationState::Cancelled);
+		}
+	}
+}
+
+FLobbyOperation* FLobbyOperationScheduler::FindOperation(FLobbyOperationId OperationId) const
+{
+	for (const TSharedRef<FLobbyOperation>& Operation : Operations)
+	{
+		if (Operation->Id == OperationId)
+		{
+			return &Operation.Get();
+		}
+	}
+	return nullptr;
+}
+
+bool FLobbyOperationScheduler::IsRunningFor(FLobbyOperationId OperationId, FName SessionName) const
+{
+	const FLobbyOperation* Operation = FindOperation(OperationId);
+	return Operation &&
+		Operation->State == ELobbyOperationState::Running &&
+		(Operation->SessionName == NAME_None || Operation->SessionName == SessionName);
+}
+
+bool FLobbyOperationScheduler::HasOutstanding(ELobbyOperationType Type, FName SessionName) const
+{
+	for (const TSharedRef<FLobbyOperation>& Operation : Operations)
+	{
+		if (Operation->Type == Type && (SessionName == NAME_None || Operation->SessionName == SessionName))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FLobbyOperationScheduler::Pump()
+{
+	// Start callbacks may complete synchronously (NULL OSS), which re-enters here
+	if (bIsPumping)
+	{
+		bPumpRequested = true;
+		return;
+	}
+
+	bIsPumping = true;
+	do
+	{
+		bPumpRequested = false;
+
+		for (int32 Index = 0; Index < Operations.Num(); ++Index)
+		{
+			TSharedRef<FLobbyOperation> Operation = Operations[Index];
+			if (Operation->State != ELobbyOperationState::Pending)
+			{
+				continue;
+			}
+
+			bool bIsReady = true;
+			bool bDependencyFailed = false;
+			for (FLobbyOperationId DependencyId : Operation->Dependencies)
+			{
+				if (FindOperation(DependencyId))
+				{
+					bIsReady = false;
+					break;
+				}
+
+				// An unknown result cannot vouch for the dependency, count it as failed
+				const bool* bDependencySucceeded = FinishedResults.Find(DependencyId);
+				if (!bDependencySucceeded || !*bDependencySucceeded)
+				{
+					bDependencyFailed = true;
+				}
+			}
+
+			if (!bIsReady)
+			{
+				continue;
+			}
+
+			if (bDependencyFailed && Operation->bRequireDependencySuccess)
+			{
+				Finish(Operation, ELobbyOperationState::Failed);
+			}
+			else
+			{
+				Operation->State = ELobbyOperationState::Running;
+
+				const double* Timeout = Timeouts.Find(Operation->Type);
+				Operation->Deadline = Timeout && *Timeout > 0.0 ? FPlatformTime::Seconds() + *Timeout : 0.0;
+
+				if (BindHandler)
+				{
+					BindHandler(*Operation);
+				}
+
+				const bool bStarted = Operation->Start && Operation->Start(*Operation);
+
+				// The operation may already have completed inside Start
+				if (!bStarted && Operation->State == ELobbyOperationState::Running)
+				{
+					Finish(Operation, ELobbyOperationState::Failed);
+				}
+			}
+
+			// The operation list may have changed, rescan from the top
+			bPumpRequested = true;
+			break;
+		}
+	}
+	while (bPumpRequested);
+	bIsPumping = false;
+}
+
+bool FLobbyOperationScheduler::Conflicts(const FLobbyOperation& A, const FLobbyOperation& B)
+{
+	const bool bAIsSearch = A.Type == ELobbyOperationType::Find;
+	const bool bBIsSearch = B.Type == ELobbyOperationType::Find;
+
+	if (bAIsSearch || bBIsSearch)
+	{
+		return bAIsSearch && bBIsSearch;
+	}
+
+	return A.SessionName == B.SessionName;
+}
+
+void FLobbyOperationScheduler::Finish(const TSharedRef<FLobbyOperation>& Operation, ELobbyOperationState FinalState)
+{
+	const bool bWasRunning = Operation->State == ELobbyOperationState::Running;
+	Operation->State = FinalState;
+
+	// The backend call is still out there, let the owner abandon it
+	const bool bWasAbandoned = FinalState == ELobbyOperationState::TimedOut ||
+		FinalState == ELobbyOperationState::Cancelled;
+	if (bWasRunning && bWasAbandoned && AbortHandler)
+	{
+		AbortHandler(*Operation);
+	}
+
+	if (bWasRunning && UnbindHandler)
+	{
+		UnbindHandler(*Operation);
+	}
+
+	Operations.Remove(Operation);
+
+	FinishedResults.Add(Operation->Id, FinalState == ELobbyOperationState::Succeeded);
+	if (Operation->Id > FinishedResultWindow)
+	{
+		TSet<FLobbyOperationId> StillNeeded;
+		for (const TSharedRef<FLobbyOperation>& Outstanding : Operations)
+		{
+			StillNeeded.Append(Outstanding->Dependencies);
+		}
+
+		const FLobbyOperationId OldestKept = Operation->Id - FinishedResultWindow;
+		for (auto It = FinishedResults.CreateIterator(); It; ++It)
+		{
+			if (It.Key() < OldestKept && !StillNeeded.Contains(It.Key()))
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	if (Operation->OnComplete)
+	{
+		Operation->OnComplete(*Operation);
+	}
+
+	Pump();
+}
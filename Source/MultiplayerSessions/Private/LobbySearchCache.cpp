@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbySearchCache.h"
+
+void FLobbySearchCache::Add(const FOnlineSessionSearchResult& SearchResult, const FLobbyInfo& LobbyInfo, double Now)
+{
+	FLobbySearchCacheEntry& Entry = Entries.FindOrAdd(LobbyInfo.LobbyId);
+	Entry.SearchResult = SearchResult;
+	Entry.LobbyInfo = LobbyInfo;
+	Entry.LastSeenTime = Now;
+}
+
+const FLobbySearchCacheEntry* FLobbySearchCache::Find(const FString& LobbyId, double Now) const
+{
+	const FLobbySearchCacheEntry* Entry = Entries.Find(LobbyId);
+	if (!Entry || IsExpired(*Entry, Now))
+	{
+		return nullptr;
+	}
+	return Entry;
+}
+
+void FLobbySearchCache::Remove(const FString& LobbyId)
+{
+	Entries.Remove(LobbyId);
+}
+
+void FLobbySearchCache::CompleteRefresh(double Now, const FLobbySearchFilter& Scope)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().LastSeenTime < Now && Scope.Matches(It.Value().LobbyInfo))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	LastRefreshTime = Now;
+}
+
+void FLobbySearchCache::Prune(double Now)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (IsExpired(It.Value(), Now))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FLobbySearchCache::Reset()
+{
+	Entries.Reset();
+	LastRefreshTime = 0.0;
+}
+
+void FLobbySearchCache::GetLobbies(TArray<FLobbyInfo>& OutLobbies, double Now) const
+{
+	OutLobbies.Reset(Entries.Num());
+	for (const TPair<FString, FLobbySearchCacheEntry>& Pair : Entries)
+	{
+		if (!IsExpired(Pair.Value, Now))
+		{
+			OutLobbies.Add(Pair.Value.LobbyInfo);
+		}
+	}
+}
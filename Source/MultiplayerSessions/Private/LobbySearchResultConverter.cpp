@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LobbySearchResultConverter.h"
+
+#include "OnlineSessionSettings.h"
+#include "LobbyAttributes.h"
+#include "LobbyMetadataCodec.h"
+#include "LobbySearchCache.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	/** Outcome of converting one result, written by the worker that owns its slot */
+	enum class EConvertedResult : uint8
+	{
+		Kept, OwnLobby, InProgress, Filtered
+	};
+}
+
+void FLobbySearchResultConverter::ConvertResult(const FOnlineSessionSearchResult& SearchResult,
+                                                FLobbyInfo& OutInfo,
+                                                const FLobbyInfo* Previous)
+{
+	ConvertResult(SearchResult, SearchResult.GetSessionIdStr(), OutInfo, Previous);
+}
+
+void FLobbySearchResultConverter::ConvertResult(const FOnlineSessionSearchResult& SearchResult,
+                                                FString&& SessionId,
+                                                FLobbyInfo& OutInfo,
+                                                const FLobbyInfo* Previous)
+{
+	const FOnlineSessionSettings& Settings = SearchResult.Session.SessionSettings;
+
+	int32 DataVersion = 0;
+	LobbyAttributes::FDataVersion::Get(Settings, DataVersion);
+
+	if (Previous && DataVersion > 0 && Previous->DataVersion == DataVersion)
+	{
+		// Host did not change anything since the last search
+		OutInfo = *Previous;
+	}
+	else
+	{
+		// Settings belong to the search result and stay const, so their strings are copied out
+		// once, straight into OutInfo. Packed metadata is decoded into OutInfo in place.
+		OutInfo.LobbyId = MoveTemp(SessionId);
+		OutInfo.HostId = SearchResult.Session.OwningUserId.IsValid()
+			                 ? SearchResult.Session.OwningUserId->ToString()
+			                 : FString();
+		FLobbyMetadataCodec::Read(Settings, OutInfo);
+	}
+
+	// Occupancy and ping are measured by the backend, never stamped by the host
+	OutInfo.MaxPlayerCount = Settings.NumPublicConnections;
+	OutInfo.CurrentPlayerCount = OutInfo.MaxPlayerCount - SearchResult.Session.NumOpenPublicConnections;
+	OutInfo.PingInMs = SearchResult.PingInMs;
+
+	// Belongs to the search that found the lobby, the friend lookup sets it again for its own results
+	OutInfo.bIsFriendLobby = false;
+}
+
+void FLobbySearchResultConverter::ConvertBatch(const TArray<FOnlineSessionSearchResult>& SearchResults,
+                                               const FUniqueNetId* LocalPlayerId,
+                                               const FLobbySearchFilter& Filter,
+                                               const FLobbySearchCache* PreviousLobbies,
+                                               double Now,
+                                               int32 ParallelThreshold,
+                                               TArray<FLobbyInfo>& OutLobbies,
+                                               TArray<int32>& OutSourceIndices)
+{
+	const int32 NumResults = SearchResults.Num();
+
+	OutLobbies.Reset();
+	OutSourceIndices.Reset(NumResults);
+	if (NumResults == 0)
+	{
+		return;
+	}
+
+	// One slot per result, so workers never touch shared state
+	OutLobbies.SetNum(NumResults);
+	TArray<EConvertedResult> Outcomes;
+	Outcomes.SetNumUninitialized(NumResults);
+
+	ParallelFor(NumResults, [&](int32 Index)
+	{
+		const FOnlineSessionSearchResult& SearchResult = SearchResults[Index];
+
+		// Filter out any lobby owned by the local player (ghost session from crash)
+		if (LocalPlayerId && SearchResult.Session.OwningUserId.IsValid() &&
+			*LocalPlayerId == *SearchResult.Session.OwningUserId)
+		{
+			Outcomes[Index] = EConvertedResult::OwnLobby;
+			return;
+		}
+
+		// A match is running, joining would only fail
+		bool bInProgress = false;
+		if (LobbyAttributes::FInProgress::Get(SearchResult.Session.SessionSettings, bInProgress) && bInProgress)
+		{
+			Outcomes[Index] = EConvertedResult::InProgress;
+			return;
+		}
+
+		// Parties are joined through invites only
+		bool bIsParty = false;
+		if (LobbyAttributes::FIsParty::Get(SearchResult.Session.SessionSettings, bIsParty) && bIsParty)
+		{
+			Outcomes[Index] = EConvertedResult::Filtered;
+			return;
+		}
+
+		// Built once, used for the cache lookup and then moved into the lobby
+		FString SessionId = SearchResult.GetSessionIdStr();
+		const FLobbySearchCacheEntry* Previous = PreviousLobbies ? PreviousLobbies->Find(SessionId, Now) : nullptr;
+		ConvertResult(SearchResult, MoveTemp(SessionId), OutLobbies[Index], Previous ? &Previous->LobbyInfo : nullptr);
+
+		// Client-side pass for whatever the backend did not filter
+		Outcomes[Index] = Filter.Matches(OutLobbies[Index]) ? EConvertedResult::Kept : EConvertedResult::Filtered;
+	}, NumResults < ParallelThreshold);
+
+	// Compact the kept lobbies in place, moving rather than copying them
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < NumResults; ++Index)
+	{
+		if (Outcomes[Index] == EConvertedResult::OwnLobby)
+		{
+			UE_LOG(LogTemp, Warning,
+			       TEXT("Filtering out own lobby (potential ghost session) from search results: %s"),
+			       *SearchResults[Index].GetSessionIdStr());
+		}
+
+		if (Outcomes[Index] != EConvertedResult::Kept)
+		{
+			continue;
+		}
+
+		if (NumKept != Index)
+		{
+			OutLobbies[NumKept] = MoveTemp(OutLobbies[Index]);
+		}
+		OutSourceIndices.Add(Index);
+		++NumKept;
+	}
+	OutLobbies.SetNum(NumKept, false);
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+	void BenchmarkSearchConversion(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 20;
+		const int32 BatchSizes[] = {100, 1000, 10000};
+
+		for (const int32 BatchSize : BatchSizes)
+		{
+			// Synthetic results carrying the settings a real lobby advertises
+			TArray<FOnlineSessionSearchResult> SearchResults;
+			SearchResults.SetNum(BatchSize);
+			for (int32 Index = 0; Index < BatchSize; ++Index)
+			{
+				FOnlineSessionSearchResult& SearchResult = SearchResults[Index];
+				SearchResult.PingInMs = Index % 200;
+				SearchResult.Session.SessionSettings.NumPublicConnections = 8;
+				SearchResult.Session.NumOpenPublicConnections = Index % 9;
+				LobbyAttributes::FHostName::Set(SearchResult.Session.SessionSettings,
+				                                FString::Printf(TEXT("Host_%d"), Index));
+				LobbyAttributes::FIsPublic::Set(SearchResult.Session.SessionSettings, Index % 4 != 0);
+			}
+
+			TArray<FLobbyInfo> Lobbies;
+			TArray<int32> SourceIndices;
+			const FLobbySearchFilter Filter;
+
+			// Single threaded, then parallel for any batch size
+			for (const int32 Threshold : {MAX_int32, 1})
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					FLobbySearchResultConverter::ConvertBatch(SearchResults, nullptr, Filter, nullptr, 0.0,
+					                                          Threshold, Lobbies, SourceIndices);
+				}
+				const double AverageMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+				UE_LOG(LogTemp, Log, TEXT("Search conversion: %5d results, %s: %.3f ms"),
+				       BatchSize, Threshold == 1 ? TEXT("parallel") : TEXT("serial  "), AverageMs);
+			}
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkSearchConversionCommand(
+		TEXT("MultiplayerSessions.BenchmarkSearchConversion"),
+		TEXT("Times lobby search result conversion on 100, 1000 and 10000 synthetic results. Optional arg: iterations"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSearchConversion));
+}
+
+#endif
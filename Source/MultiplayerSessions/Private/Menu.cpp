@@ -10,13 +10,38 @@
 #include "Engine/Engine.h"
 #include "Engine/GameInstance.h"
 #include "OnlineSessionSettings.h"
+#include "LobbyAttributes.h"
 
 void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FString LobbyPath)
 {
+	LobbyMapPath = LobbyPath;
 	PathToLobby = LobbyPath + "?listen";
 	NumPublicConnections = NumberOfPublicConnections;
 	MatchType = TypeOfMatch;
-	AddToViewport();
+
+	// Started with a lobby link, the subsystem joins and travels on its own.
+	// The menu waits hidden in the viewport and only opens if that join fails.
+	UGameInstance* OwningGameInstance = GetGameInstance();
+	UMultiplayerSessionsSubsystem* Subsystem =
+		OwningGameInstance ? OwningGameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+	if (Subsystem && Subsystem->IsJoiningFromLink())
+	{
+		if (!IsInViewport())
+		{
+			AddToViewport();
+		}
+		SetVisibility(ESlateVisibility::Collapsed);
+
+		MultiplayerSessionsSubsystem = Subsystem;
+		MultiplayerSessionsSubsystem->MultiplayerOnLobbyJoinComplete.AddUniqueDynamic(
+			this, &ThisClass::OnLinkJoinComplete);
+		return;
+	}
+
+	if (!IsInViewport())
+	{
+		AddToViewport();
+	}
 	SetVisibility(ESlateVisibility::Visible);
 	SetIsFocusable(true);
 
@@ -50,6 +75,8 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FStr
 		MultiplayerSessionsSubsystem->MultiplayerOnLobbyListUpdated.AddDynamic(this, &ThisClass::OnLobbyListUpdated);
 		MultiplayerSessionsSubsystem->MultiplayerOnPlayerJoinedLobby.AddDynamic(this, &ThisClass::OnPlayerJoinedLobby);
 		MultiplayerSessionsSubsystem->MultiplayerOnLobbyJoinComplete.AddDynamic(this, &ThisClass::OnLobbyJoinComplete);
+		MultiplayerSessionsSubsystem->MultiplayerOnLobbyInviteAccepted.AddDynamic(
+			this, &ThisClass::OnLobbyInviteAccepted);
 
 		/* DEPRECATED DELEGATES */
 		MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &ThisClass::OnCreateSession);
@@ -81,6 +108,9 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FStr
 
 		// Start on main menu view
 		SwitchToView(EMenuView::MainMenu);
+
+		// Search ahead so the browser opens on current results
+		MultiplayerSessionsSubsystem->WarmUpLobbySearch();
 	}
 }
 
@@ -97,6 +127,10 @@ void UMenu::NativeDestruct()
 			this, &ThisClass::OnPlayerJoinedLobby);
 		MultiplayerSessionsSubsystem->MultiplayerOnLobbyJoinComplete.RemoveDynamic(
 			this, &ThisClass::OnLobbyJoinComplete);
+		MultiplayerSessionsSubsystem->MultiplayerOnLobbyInviteAccepted.RemoveDynamic(
+			this, &ThisClass::OnLobbyInviteAccepted);
+		MultiplayerSessionsSubsystem->MultiplayerOnLobbyJoinComplete.RemoveDynamic(
+			this, &ThisClass::OnLinkJoinComplete);
 
 		// Deprecated
 		MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.RemoveDynamic(
@@ -148,6 +182,11 @@ bool UMenu::Initialize()
 		JoinButton->OnClicked.AddDynamic(this, &ThisClass::JoinButtonClicked);
 	}
 
+	if (QuickPlayButton)
+	{
+		QuickPlayButton->OnClicked.AddDynamic(this, &ThisClass::QuickPlayButtonClicked);
+	}
+
 	return true;
 }
 
@@ -156,6 +195,12 @@ void UMenu::HostButtonClicked()
 {
 	PrintDebugMessage(FString(TEXT("Host Button Clicked!")), false, FColor::Yellow);
 	SwitchToView(EMenuView::CreateLobby);
+
+	// The session is created while the host fills in the form, confirming only updates it
+	if (MultiplayerSessionsSubsystem)
+	{
+		MultiplayerSessionsSubsystem->PrepareLobby();
+	}
 }
 
 void UMenu::JoinButtonClicked()
@@ -170,6 +215,17 @@ void UMenu::JoinButtonClicked()
 	}
 }
 
+void UMenu::QuickPlayButtonClicked()
+{
+	PrintDebugMessage(FString(TEXT("Quick Play Button Clicked!")), false, FColor::Yellow);
+
+	// Result arrives in OnLobbyJoinComplete like a regular join
+	if (MultiplayerSessionsSubsystem)
+	{
+		MultiplayerSessionsSubsystem->QuickJoin(QuickJoinPolicy);
+	}
+}
+
 // Widget Callback Handlers
 void UMenu::OnLobbyCreationComplete(bool bSuccess)
 {
@@ -181,6 +237,10 @@ void UMenu::OnLobbyCreationComplete(bool bSuccess)
 	else
 	{
 		// User cancelled or creation failed - return to main menu
+		if (MultiplayerSessionsSubsystem)
+		{
+			MultiplayerSessionsSubsystem->CancelPreparedLobby();
+		}
 		SwitchToView(EMenuView::MainMenu);
 	}
 }
@@ -233,8 +293,26 @@ void UMenu::JoinSelectedLobby(const FLobbyInfo& LobbyInfo, const FString& Passwo
 		FString::Printf(TEXT("Attempting to join %s's lobby..."), *LobbyInfo.HostName),
 		false, FColor::Cyan);
 
-	// Call subsystem to join lobby
-	MultiplayerSessionsSubsystem->JoinLobby(LobbyInfo, Password);
+	// By id, so recent lobbies no search has returned yet are resolved first
+	MultiplayerSessionsSubsystem->JoinLobbyById(LobbyInfo.LobbyId, Password);
+}
+
+void UMenu::OnLinkJoinComplete(ELobbyJoinResult Result)
+{
+	if (MultiplayerSessionsSubsystem)
+	{
+		MultiplayerSessionsSubsystem->MultiplayerOnLobbyJoinComplete.RemoveDynamic(
+			this, &ThisClass::OnLinkJoinComplete);
+	}
+
+	// The subsystem is already travelling to the linked lobby
+	if (Result == ELobbyJoinResult::Success)
+	{
+		return;
+	}
+
+	PrintDebugMessage(TEXT("Could not join the linked lobby"), true);
+	MenuSetup(NumPublicConnections, MatchType, LobbyMapPath);
 }
 
 void UMenu::OnLobbyJoinComplete(ELobbyJoinResult Result)
@@ -290,6 +368,32 @@ void UMenu::OnLobbyJoinComplete(ELobbyJoinResult Result)
 		}
 		break;
 
+	case ELobbyJoinResult::MatchInProgress:
+		PrintDebugMessage(TEXT("Match already in progress"), true);
+
+		// Hide password dialog
+		if (PasswordInputWidget)
+		{
+			PasswordInputWidget->Hide();
+		}
+
+		// The lobby no longer belongs in the list
+		if (LobbyListWidget)
+		{
+			LobbyListWidget->RefreshLobbyList();
+		}
+		break;
+
+	case ELobbyJoinResult::TimedOut:
+		PrintDebugMessage(TEXT("Lobby did not respond in time"), true);
+
+		// Hide password dialog
+		if (PasswordInputWidget)
+		{
+			PasswordInputWidget->Hide();
+		}
+		break;
+
 	case ELobbyJoinResult::ConnectionFailed:
 	case ELobbyJoinResult::UnknownError:
 	default:
@@ -304,6 +408,20 @@ void UMenu::OnLobbyJoinComplete(ELobbyJoinResult Result)
 	}
 }
 
+void UMenu::OnLobbyInviteAccepted(const FLobbyInfo& LobbyInfo, bool bWasSuccessful)
+{
+	if (!bWasSuccessful)
+	{
+		PrintDebugMessage(TEXT("Invite could not be accepted"), true);
+		return;
+	}
+
+	// The subsystem joins and travels, the result arrives in OnLobbyJoinComplete
+	PrintDebugMessage(
+		FString::Printf(TEXT("Joining %s's lobby from invite..."), *LobbyInfo.HostName),
+		false, FColor::Cyan);
+}
+
 // Travel Lobby Method
 void UMenu::TravelToLobby()
 {
@@ -318,6 +436,9 @@ void UMenu::TravelToLobby()
 	if (ConnectAddress.IsEmpty())
 	{
 		PrintDebugMessage(TEXT("Failed to get server address"), true);
+
+		// Lets the subsystem fall back to the next lobby of the search
+		MultiplayerSessionsSubsystem->TravelToJoinedLobby();
 		return;
 	}
 
@@ -328,16 +449,8 @@ void UMenu::TravelToLobby()
 	// Clean up menu
 	MenuTearDown();
 
-	// Travel as client
-	UWorld* World = GetWorld();
-	if (World)
-	{
-		APlayerController* PlayerController = World->GetFirstPlayerController();
-		if (PlayerController)
-		{
-			PlayerController->ClientTravel(ConnectAddress, ETravelType::TRAVEL_Absolute);
-		}
-	}
+	// Travel as client, a failed travel is retried with the next lobby by the subsystem
+	MultiplayerSessionsSubsystem->TravelToJoinedLobby();
 }
 
 // View Switching
@@ -347,6 +460,12 @@ void UMenu::SwitchToView(EMenuView View)
 	{
 		MenuSwitcher->SetActiveWidgetIndex(static_cast<int32>(View));
 	}
+
+	// Only refresh the lobby list in the background while it is on screen
+	if (LobbyListWidget)
+	{
+		LobbyListWidget->SetBrowsingActive(View == EMenuView::LobbyBrowser);
+	}
 }
 
 void UMenu::OnCreateLobby(bool bWasSuccessful, const FLobbyInfo& LobbyInfo)
@@ -532,7 +651,7 @@ void UMenu::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResu
 			FString Id = Result.GetSessionIdStr();
 			FString User = Result.Session.OwningUserName;
 
-			Result.Session.SessionSettings.Get(FName("MatchType"), SettingsValue);
+			LobbyAttributes::FMatchType::Get(Result.Session.SessionSettings, SettingsValue);
 
 			if (SettingsValue == MatchType)
 			{
@@ -6,10 +6,25 @@
 #include "OnlineSubsystem.h"
 #include "OnlineSubsystemUtils.h"
 #include "OnlineSessionSettings.h"
+#include "Engine/Engine.h"
 #include "Engine/LocalPlayer.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
 #include "Online/OnlineSessionNames.h"
-
-UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem()
+#include "Interfaces/OnlineFriendsInterface.h"
+#include "Misc/CommandLine.h"
+#include "Misc/NetworkVersion.h"
+#include "Misc/Parse.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "LobbyAttributes.h"
+#include "LobbyMetadataCodec.h"
+#include "LobbySearchResultConverter.h"
+#include "LobbyListSnapshot.h"
+
+UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem() :
+	LobbyHistory(nullptr)
 {
 }
 
@@ -19,42 +34,38 @@ void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collect
 {
 	Super::Initialize(Collection);
 
+	// Shown by the browser right away, the first search validates them
+	LoadLobbyHistory();
+	LoadLobbyListSnapshot();
+
 	UWorld* World = GetWorld();
 	IOnlineSubsystem* Subsystem = Online::GetSubsystem(World);
 	if (Subsystem)
 	{
 		SessionInterface = Subsystem->GetSessionInterface();
 
-		// Initialize the delegates
-		CreateSessionCompleteDelegate =
-			FOnCreateSessionCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnCreateSessionComplete
-			);
-
-		FindSessionsCompleteDelegate =
-			FOnFindSessionsCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnFindSessionsComplete
-			);
-
-		JoinSessionCompleteDelegate =
-			FOnJoinSessionCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnJoinSessionComplete
-			);
-
-		DestroySessionCompleteDelegate =
-			FOnDestroySessionCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnDestroySessionComplete
-			);
-
-		StartSessionCompleteDelegate =
-			FOnStartSessionCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnStartSessionComplete
-			);
-
-		UpdateSessionCompleteDelegate =
-			FOnUpdateSessionCompleteDelegate::CreateUObject(
-				this, &ThisClass::OnUpdateSessionComplete
-			);
+		// Every operation registers its own completion delegate while it runs
+		Scheduler.BindHandler = [this](FLobbyOperation& Operation) { BindOperationDelegate(Operation); };
+		Scheduler.UnbindHandler = [this](FLobbyOperation& Operation) { ClearOperationDelegate(Operation); };
+		Scheduler.AbortHandler = [this](FLobbyOperation& Operation) { AbortOperation(Operation); };
+
+		// A backend that never calls back fails the operation instead of stalling the session
+		Scheduler.SetTimeout(ELobbyOperationType::Create, CreateTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::Find, FindTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::FindById, FindTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::FindFriends, FindTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::Join, JoinTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::Update, UpdateTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::Destroy, DestroyTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::Start, StartTimeout);
+		Scheduler.SetTimeout(ELobbyOperationType::End, EndTimeout);
+
+		UGameInstance* GameInstance = GetGameInstance();
+		if (GameInstance)
+		{
+			GameInstance->GetTimerManager().SetTimer(OperationTimeoutTimer, this, &ThisClass::ExpireOperations,
+			                                         1.f, true);
+		}
 
 		SessionParticipantLeftDelegate =
 			FOnSessionParticipantLeftDelegate::CreateUObject(
@@ -79,7 +90,22 @@ void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collect
 			SessionInterface->AddOnSessionParticipantJoinedDelegate_Handle(
 				SessionParticipantJoinedDelegate
 			);
+
+		// Persistent delegate for accepted invites
+		SessionUserInviteAcceptedDelegateHandle =
+			SessionInterface->AddOnSessionUserInviteAcceptedDelegate_Handle(
+				FOnSessionUserInviteAcceptedDelegate::CreateUObject(
+					this, &ThisClass::OnSessionUserInviteAccepted)
+			);
+	}
+
+	// Failed join travels fall back to the next lobby instead of leaving the player in the menu
+	if (GEngine)
+	{
+		TravelFailureHandle = GEngine->OnTravelFailure().AddUObject(this, &ThisClass::OnTravelFailure);
+		NetworkFailureHandle = GEngine->OnNetworkFailure().AddUObject(this, &ThisClass::OnNetworkFailure);
 	}
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::OnPostLoadMap);
 
 	// Clean up any ghost sessions from previous crashes
 	if (SessionInterface.IsValid())
@@ -88,36 +114,61 @@ void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collect
 		if (ExistingSession)
 		{
 			// Destroy ghost session without broadcasting (silent cleanup)
-			bIsInitializing = true;
+			// Game session operations queued meanwhile chain behind this one
 			UE_LOG(LogTemp, Warning, TEXT("Found ghost session on startup, cleaning up..."));
 
-			// Bind delegate to know when cleanup completes
-			DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
-				DestroySessionCompleteDelegate);
-
-			SessionInterface->DestroySession(NAME_GameSession);
-			return; // Don't set complete flag yet
+			ScheduleSessionCleanup(NAME_GameSession, [](const FLobbyOperation& Operation)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Ghost session cleanup complete, subsystem ready."));
+			});
 		}
 	}
 
-	bInitializationComplete = true;
+	// Launchers and test rigs go straight into a lobby, the join chains behind the ghost cleanup
+	JoinLobbyFromLink(FCommandLine::Get());
 }
 
 void UMultiplayerSessionsSubsystem::Deinitialize()
 {
+	StopLobbyBrowsing();
+	SaveLobbyListSnapshot();
+
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance)
+	{
+		GameInstance->GetTimerManager().ClearTimer(OperationTimeoutTimer);
+		GameInstance->GetTimerManager().ClearTimer(PendingLobbyUpdate.FlushTimer);
+	}
+
+	// Drop outstanding operations and their completion delegates
+	Scheduler.Reset();
+	ResolveAbandonedSearch();
+	AbandonedSearch = FAbandonedSearch();
+	JoinPipeline = FJoinPipeline();
+
+	if (GEngine)
+	{
+		GEngine->OnTravelFailure().Remove(TravelFailureHandle);
+		GEngine->OnNetworkFailure().Remove(NetworkFailureHandle);
+	}
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
 	/* PERSISTENT DELEGATES */
 	// Removal of persistent delegates
 	if (SessionInterface.IsValid())
 	{
 		SessionInterface->ClearOnSessionParticipantLeftDelegate_Handle(SessionParticipantLeftDelegateHandle);
 		SessionInterface->ClearOnSessionParticipantJoinedDelegate_Handle(SessionParticipantJoinedDelegateHandle);
+		SessionInterface->ClearOnSessionUserInviteAcceptedDelegate_Handle(SessionUserInviteAcceptedDelegateHandle);
 
-		// Clean up session on proper shutdown
-		FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-		if (ExistingSession)
+		// Clean up sessions on proper shutdown
+		for (const FName SessionName : {NAME_GameSession, NAME_PartySession})
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Destroying session on shutdown..."));
-			SessionInterface->DestroySession(NAME_GameSession);
+			if (SessionInterface->GetNamedSession(SessionName))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Destroying session %s on shutdown..."), *SessionName.ToString());
+				SessionInterface->DestroySession(SessionName);
+			}
 		}
 	}
 
@@ -126,630 +177,2809 @@ void UMultiplayerSessionsSubsystem::Deinitialize()
 
 /* LOBBY HANDLERS */
 
-void UMultiplayerSessionsSubsystem::CreateLobby(const FLobbySettings& LobbySettings)
+void UMultiplayerSessionsSubsystem::CreateLobby(const FLobbySettings& LobbySettings, FName SessionName)
 {
-	// Block if still initializing
-	if (bIsInitializing || !bInitializationComplete)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Subsystem still initializing, please wait..."));
-		MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
-		return;
-	}
-
 	if (!SessionInterface.IsValid())
 	{
 		MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
 		return;
 	}
 
-	// Clean up any existing session before creating new one
-	FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession)
+	// Preparing and the match lifecycle only concern the game lobby
+	if (SessionName == NAME_GameSession)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Destroying existing session before creating new lobby..."));
-
-		// Store settings for after destruction
-		PendingLobbySettings = LobbySettings;
-		bHasPendingLobbyCreation = true;
+		// A new lobby starts out open, whatever became of the previous match
+		SetLobbyLifecycleState(ELobbyLifecycleState::Lobby);
 
-		// Destroy and recreate in callback
-		DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
-			DestroySessionCompleteDelegate);
-		SessionInterface->DestroySession(NAME_GameSession);
-		return;
+		// A session prepared while the host filled in the form only needs the final settings
+		if (PreparedLobby.bIsActive)
+		{
+			PublishPreparedLobby(LobbySettings);
+			return;
+		}
 	}
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!LocalPlayer)
+	// Clean up any existing session of that name before creating new one
+	// The create operation chains behind the cleanup and fails with it
+	if (SessionInterface->GetNamedSession(SessionName))
 	{
-		MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
-		return;
+		UE_LOG(LogTemp, Warning, TEXT("Destroying existing session before creating new lobby..."));
+		ScheduleSessionCleanup(SessionName);
 	}
 
-	bIsLobbyOperation = true;
-	PendingLobbySettings = LobbySettings;
-
-	// Register Delegate
-	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(
-		CreateSessionCompleteDelegate);
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Create;
+	Operation.SessionName = SessionName;
+	Operation.Start = [this, LobbySettings](FLobbyOperation& Op)
+	{
+		// A dedicated server hosts without a local player
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if ((!LocalPlayer && !IsDedicatedServer()) || !SessionInterface.IsValid())
+		{
+			return false;
+		}
 
-	// Configure session settings
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
-	LastSessionSettings->bIsLANMatch = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
-	LastSessionSettings->NumPublicConnections = LobbySettings.MaxPlayers;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
+		LastSessionSettings = MakeLobbySessionSettings(LobbySettings, GetLobbyHostName(LocalPlayer), true);
 
-	// Lobby Metadata
-	LastSessionSettings->Set(FName("LobbyIsPublic"), LobbySettings.bIsPublic,
-	                         EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+		// A new lobby starts open, whatever a match of the previous one closed
+		if (Op.SessionName == NAME_GameSession)
+		{
+			OpenLobbyJoinability = FLobbyJoinability();
+		}
 
-	// Store password hash for private lobbies
-	if (!LobbySettings.bIsPublic && !LobbySettings.Password.IsEmpty())
+		// Create Lobby
+		return CreateHostedSession(Op.SessionName, *LastSessionSettings);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
 	{
-		FString PasswordHash = HashPassword(LobbySettings.Password);
-		LastSessionSettings->Set(FName("PasswordHash"), PasswordHash,
-		                         EOnlineDataAdvertisementType::ViaOnlineService);
-	}
-
-	// Store host name into metadata
-	FString HostName = LocalPlayer->GetNickname();
-	LastSessionSettings->Set(FName("HostName"), HostName,
-	                         EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+		if (Op.Succeeded())
+		{
+			FLobbyInfo LobbyInfo = CreateLobbyInfoFromSession(Op.SessionName);
+			MultiplayerOnLobbyCreated.Broadcast(true, LobbyInfo);
+		}
+		else
+		{
+			MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
+		}
+	};
 
-	// Create Lobby
-	bool bSuccess = SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                                NAME_GameSession, *LastSessionSettings);
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
 
-	if (!bSuccess)
+void UMultiplayerSessionsSubsystem::PrepareLobby()
+{
+	if (!bPrepareHostedLobby || !SessionInterface.IsValid() || PreparedLobby.bIsActive)
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-		bIsLobbyOperation = false;
-		MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
+		return;
 	}
-}
 
-void UMultiplayerSessionsSubsystem::FindLobbies(int32 MaxResult)
-{
-	if (!SessionInterface.IsValid())
+	// Never replace a session the player is actually in
+	if (SessionInterface->GetNamedSession(NAME_GameSession) ||
+		Scheduler.HasOutstanding(ELobbyOperationType::Create, NAME_GameSession) ||
+		IsJoiningLobby())
 	{
-		MultiplayerOnLobbyListUpdated.Broadcast(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
 	if (!LocalPlayer)
 	{
-		MultiplayerOnLobbyListUpdated.Broadcast(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
-	// Check for stale session from previous failed join/disconnect
-	// If we're not the host of an existing session, destroy it before searching
-	FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession)
+	UE_LOG(LogTemp, Log, TEXT("Preparing hidden lobby session"));
+	PreparedLobby.bIsActive = true;
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Create;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this](FLobbyOperation& Op)
 	{
-		// Check if we own this session (we're the host)
-		FUniqueNetIdRepl LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
-		bool bIsHost = ExistingSession->OwningUserId.IsValid() &&
-			LocalPlayerId.IsValid() &&
-			*LocalPlayerId == *ExistingSession->OwningUserId;
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		// Default settings, not advertised until the host confirms
+		LastSessionSettings = MakeLobbySessionSettings(FLobbySettings(), GetLobbyHostName(LocalPlayer), false);
+		return SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(),
+		                                       Op.SessionName, *LastSessionSettings);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		// A publish queued meanwhile fails with the create and falls back to a full create
+		if (!Op.Succeeded())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not prepare hidden lobby session"));
+			PreparedLobby.bIsActive = false;
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::CancelPreparedLobby()
+{
+	if (!PreparedLobby.bIsActive)
+	{
+		return;
+	}
 
-		if (!bIsHost)
+	UE_LOG(LogTemp, Log, TEXT("Dropping prepared lobby session"));
+	PreparedLobby.bIsActive = false;
+	ScheduleSessionCleanup(NAME_GameSession);
+}
+
+void UMultiplayerSessionsSubsystem::PublishPreparedLobby(const FLobbySettings& LobbySettings)
+{
+	PreparedLobby.bIsActive = false;
+
+	// Chains behind the prepare create, which may still be running
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Update;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this, LobbySettings](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		const FNamedOnlineSession* PreparedSession =
+			SessionInterface.IsValid() ? SessionInterface->GetNamedSession(Op.SessionName) : nullptr;
+		if (!LocalPlayer || !PreparedSession)
 		{
-			// We have a stale client session - clean it up before searching
-			UE_LOG(LogTemp, Warning, TEXT("Found stale client session before search, cleaning up..."));
+			return false;
+		}
 
-			// Store search params for after cleanup
-			PendingSearchMaxResults = MaxResult;
-			bHasPendingSearch = true;
+		LastSessionSettings = MakeLobbySessionSettings(LobbySettings, GetLobbyHostName(LocalPlayer), true);
 
-			DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
-				DestroySessionCompleteDelegate);
-			SessionInterface->DestroySession(NAME_GameSession);
+		// Fresh settings restart the stamp, continue from the prepared session's so the publish reads as a change
+		int32 DataVersion = 0;
+		LobbyAttributes::FDataVersion::Get(PreparedSession->SessionSettings, DataVersion);
+		LobbyAttributes::FDataVersion::Set(*LastSessionSettings, DataVersion);
+		FLobbyMetadataCodec::BumpDataVersion(*LastSessionSettings);
+
+		return SessionInterface->UpdateSession(Op.SessionName, *LastSessionSettings, true);
+	};
+	Operation.OnComplete = [this, LobbySettings](const FLobbyOperation& Op)
+	{
+		if (Op.Succeeded())
+		{
+			MultiplayerOnLobbyCreated.Broadcast(true, CreateLobbyInfoFromSession());
 			return;
 		}
-	}
 
-	// Proceed with search
-	PerformFindLobbies(MaxResult);
+		// The slow path still works, it replaces whatever is left of the prepared session
+		UE_LOG(LogTemp, Warning, TEXT("Could not publish prepared lobby, creating a new one"));
+		CreateLobby(LobbySettings);
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
 
-void UMultiplayerSessionsSubsystem::PerformFindLobbies(int32 MaxResult)
+TSharedPtr<FOnlineSessionSettings> UMultiplayerSessionsSubsystem::MakeLobbySessionSettings(
+	const FLobbySettings& LobbySettings, const FString& HostName, bool bAdvertise) const
 {
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!LocalPlayer || !SessionInterface.IsValid())
-	{
-		MultiplayerOnLobbyListUpdated.Broadcast(TArray<FLobbyInfo>(), false);
-		return;
+	// Configure session settings
+	TSharedPtr<FOnlineSessionSettings> Settings = MakeShared<FOnlineSessionSettings>();
+	Settings->bIsLANMatch = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
+	Settings->NumPublicConnections = LobbySettings.MaxPlayers;
+	Settings->bAllowJoinInProgress = true;
+	Settings->bShouldAdvertise = bAdvertise;
+	// Presence and lobby use cannot change after creation on every backend, so a prepared session has them too.
+	// Joining through presence or invites follows advertising, the publish update switches them on.
+	Settings->bUsesPresence = true;
+	Settings->bAllowJoinViaPresence = bAdvertise;
+	Settings->bAllowInvites = bAdvertise;
+	Settings->bUseLobbiesIfAvailable = true;
+
+	// No user to own a lobby or carry presence, the backend lists the server itself
+	if (IsDedicatedServer())
+	{
+		Settings->bIsDedicated = true;
+		Settings->bUsesPresence = false;
+		Settings->bAllowJoinViaPresence = false;
+		Settings->bAllowInvites = false;
+		Settings->bUseLobbiesIfAvailable = false;
 	}
 
-	bIsLobbySearch = true;
+	// Lobby Metadata
+	LobbyAttributes::FMaxPlayers::Set(*Settings, LobbySettings.MaxPlayers);
+
+	// Store password hash for private lobbies
+	if (!LobbySettings.bIsPublic && !LobbySettings.Password.IsEmpty())
+	{
+		FString PasswordHash = HashPassword(LobbySettings.Password);
+		LobbyAttributes::FPasswordHash::Set(*Settings, PasswordHash);
+	}
 
-	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(
-		FindSessionsCompleteDelegate);
+	// Browser-visible metadata, packed into one setting if configured
+	FLobbyInfo Metadata;
+	Metadata.bIsPublic = LobbySettings.bIsPublic;
+	Metadata.HostName = HostName;
+	Metadata.GameMode = LobbySettings.GameMode;
+	Metadata.Region = LobbySettings.Region;
+	Metadata.BuildVersion = static_cast<int32>(FNetworkVersion::GetLocalNetworkVersion());
+	FLobbyMetadataCodec::Write(*Settings, Metadata, bPackLobbyMetadata);
+	FLobbyMetadataCodec::BumpDataVersion(*Settings);
 
-	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
-	LastSessionSearch->MaxSearchResults = MaxResult;
-	LastSessionSearch->bIsLanQuery = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
-	LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
+	return Settings;
+}
 
-	bool bSuccess = SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                               LastSessionSearch.ToSharedRef());
+bool UMultiplayerSessionsSubsystem::IsDedicatedServer() const
+{
+	return IsRunningDedicatedServer();
+}
 
-	if (!bSuccess)
+FString UMultiplayerSessionsSubsystem::GetLobbyHostName(const ULocalPlayer* LocalPlayer) const
+{
+	if (LocalPlayer)
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
-		bIsLobbySearch = false;
-		MultiplayerOnLobbyListUpdated.Broadcast(TArray<FLobbyInfo>(), false);
+		return LocalPlayer->GetNickname();
 	}
+
+	return DedicatedServerName.IsEmpty() ? FString(FPlatformProcess::ComputerName()) : DedicatedServerName;
 }
 
-void UMultiplayerSessionsSubsystem::JoinLobby(const FLobbyInfo& LobbyInfo, const FString& Password)
+bool UMultiplayerSessionsSubsystem::CreateHostedSession(FName SessionName, const FOnlineSessionSettings& Settings)
 {
-	if (!SessionInterface.IsValid())
+	// The server's own identity owns the session, the hosting player number is unused
+	if (IsDedicatedServer())
 	{
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::UnknownError);
-		return;
+		return SessionInterface->CreateSession(0, SessionName, Settings);
 	}
 
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
 	if (!LocalPlayer)
 	{
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::UnknownError);
+		return false;
+	}
+
+	return SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), SessionName, Settings);
+}
+
+void UMultiplayerSessionsSubsystem::FindLobbies(int32 MaxResult, const FLobbySearchFilter& Filter)
+{
+	if (!SessionInterface.IsValid())
+	{
+		BroadcastLobbyList(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
-	if (!LastSessionSearch.IsValid() || LastSessionSearch->SearchResults.Num() == 0)
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer)
 	{
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::LobbyNotFound);
+		BroadcastLobbyList(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
-	const FOnlineSessionSearchResult* FoundResult = nullptr;
-	for (const FOnlineSessionSearchResult& Result : LastSessionSearch->SearchResults)
+	// Stale-while-revalidate: answer from memory right away, refresh in the background
+	const double Now = FPlatformTime::Seconds();
+	SearchCache.SetTimeToLive(SearchCacheTimeToLive);
+	SearchCache.Prune(Now);
+
+	if (SearchCache.HasRefreshed())
 	{
-		if (Result.GetSessionIdStr() == LobbyInfo.LobbyId)
+		TArray<FLobbyInfo> CachedLobbies;
+		SearchCache.GetLobbies(CachedLobbies, Now);
+		CachedLobbies.RemoveAll([&Filter](const FLobbyInfo& Lobby) { return !Filter.Matches(Lobby); });
+		MergeFriendLobbies(CachedLobbies);
+		SetLastLobbyListFilter(Filter);
+		BroadcastLobbyList(CachedLobbies, true);
+
+		if (SearchCache.GetAge(Now) < SearchCacheFreshPeriod)
 		{
-			FoundResult = &Result;
-			break;
+			return;
 		}
 	}
 
-	if (!FoundResult)
+	// The same search already queued or in flight will broadcast fresh results,
+	// a different one queues behind it
+	if (Scheduler.FindOperation(LobbySearchRequest.OperationId) &&
+		LobbySearchRequest.MaxResult == MaxResult && LobbySearchRequest.Filter == Filter)
 	{
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::LobbyNotFound);
 		return;
 	}
 
-	if (FoundResult->Session.NumOpenPublicConnections <= 0)
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Find;
+
+	// Check for stale session from previous failed join/disconnect, only once a backend search is due
+	const FLobbyOperationId CleanupId = ScheduleStaleSessionCleanup();
+	if (CleanupId != INVALID_LOBBY_OPERATION)
 	{
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::LobbyFull);
-		return;
+		Operation.Dependencies.Add(CleanupId);
 	}
 
-	bool bIsPublic = true;
-	FoundResult->Session.SessionSettings.Get(FName("LobbyIsPublic"), bIsPublic);
-
-	// Password Validation
-	if (!bIsPublic)
+	Operation.Start = [this, MaxResult, Filter](FLobbyOperation& Op)
 	{
-		FString StoredHash;
-		FoundResult->Session.SessionSettings.Get(FName("PasswordHash"), StoredHash);
-
-		if (!ValidatePassword(Password, StoredHash))
+		return PerformFindLobbies(MaxResult, Filter);
+	};
+	Operation.OnComplete = [this, Filter](const FLobbyOperation& Op)
+	{
+		// Whoever cancelled the search is no longer waiting for it
+		if (Op.WasCancelled())
 		{
-			MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::WrongPassword);
 			return;
 		}
-	}
-
-	bIsLobbyJoin = true;
 
-	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(
-		JoinSessionCompleteDelegate);
+		HandleLobbySearchComplete(Op.Succeeded(), Filter);
+	};
 
-	bool bSuccess = SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                              NAME_GameSession,
-	                                              *FoundResult);
-
-	if (!bSuccess)
-	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
-		bIsLobbyJoin = false;
-		MultiplayerOnLobbyJoinComplete.Broadcast(ELobbyJoinResult::ConnectionFailed);
-	}
+	LobbySearchRequest.OperationId = Scheduler.Enqueue(MoveTemp(Operation));
+	LobbySearchRequest.MaxResult = MaxResult;
+	LobbySearchRequest.Filter = Filter;
 }
 
-void UMultiplayerSessionsSubsystem::UpdateLobbySettings(const FLobbySettings& NewSettings)
+void UMultiplayerSessionsSubsystem::FindLobbiesWithPlan(const FLobbySearchPlan& Plan)
 {
-	if (!SessionInterface.IsValid())
+	if (Plan.Queries.Num() == 0)
 	{
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		FindLobbies(Plan.MaxResultsPerQuery);
 		return;
 	}
 
-	if (!IsLobbyHost())
+	if (!SessionInterface.IsValid() || !GetWorld()->GetFirstLocalPlayerFromController())
 	{
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		BroadcastLobbyList(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (!Session)
-	{
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
-		return;
-	}
+	// Results of a replaced plan still in flight are dropped by the generation check
+	const uint32 Generation = PlannedSearch.Generation + 1;
+	PlannedSearch = FLobbyPlannedSearch();
+	PlannedSearch.bIsActive = true;
+	PlannedSearch.Generation = Generation;
+	PlannedSearch.Plan = Plan;
+
+	RunNextPlannedQuery();
+}
+
+FLobbySearchPlan UMultiplayerSessionsSubsystem::MakePreferredSearchPlan(const FString& Region, const FString& GameMode)
+{
+	FLobbySearchPlan Plan;
+	Plan.Ranking.PreferredRegion = Region;
+	Plan.Ranking.PreferredGameMode = GameMode;
 
-	FOnlineSessionSettings UpdatedSessionSettings = Session->SessionSettings;
-	UpdatedSessionSettings.NumPublicConnections = NewSettings.MaxPlayers;
-	UpdatedSessionSettings.Set(FName("LobbyIsPublic"), NewSettings.bIsPublic,
-	                           EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	FLobbySearchFilter Query;
+	Query.bOnlyNotFull = true;
+	Query.BuildVersion = static_cast<int32>(FNetworkVersion::GetLocalNetworkVersion());
 
-	// Update password hash
-	if (!NewSettings.bIsPublic && !NewSettings.Password.IsEmpty())
+	// Each query drops the most specific preference, an empty preference adds no query of its own
+	if (!Region.IsEmpty() && !GameMode.IsEmpty())
 	{
-		FString PasswordHash = HashPassword(NewSettings.Password);
-		UpdatedSessionSettings.Set(FName("PasswordHash"), PasswordHash,
-		                           EOnlineDataAdvertisementType::ViaOnlineService);
+		Query.Region = Region;
+		Query.GameMode = GameMode;
+		Plan.Queries.Add(Query);
 	}
-	else
+	if (!Region.IsEmpty())
 	{
-		// Switching to public lobby or empty password
-		UpdatedSessionSettings.Remove(FName("PasswordHash"));
+		Query.Region = Region;
+		Query.GameMode.Empty();
+		Plan.Queries.Add(Query);
+	}
+	if (!GameMode.IsEmpty())
+	{
+		Query.Region.Empty();
+		Query.GameMode = GameMode;
+		Plan.Queries.Add(Query);
 	}
 
-	UpdateSessionCompleteDelegateHandle = SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(
-		UpdateSessionCompleteDelegate);
+	Query.Region.Empty();
+	Query.GameMode.Empty();
+	Plan.Queries.Add(Query);
 
-	bool bSuccess = SessionInterface->UpdateSession(NAME_GameSession, UpdatedSessionSettings);
+	// Older hosts are still worth listing
+	Query.BuildVersion = 0;
+	Plan.Queries.Add(Query);
 
-	if (!bSuccess)
+	return Plan;
+}
+
+bool UMultiplayerSessionsSubsystem::RunNextPlannedQuery()
+{
+	if (!PlannedSearch.Plan.Queries.IsValidIndex(PlannedSearch.NextQuery))
 	{
-		SessionInterface->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegateHandle);
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		return false;
 	}
+
+	const FLobbySearchFilter Filter = PlannedSearch.Plan.Queries[PlannedSearch.NextQuery++];
+	const int32 MaxResult = PlannedSearch.Plan.MaxResultsPerQuery;
+	const uint32 Generation = PlannedSearch.Generation;
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Find;
+
+	const FLobbyOperationId CleanupId = ScheduleStaleSessionCleanup();
+	if (CleanupId != INVALID_LOBBY_OPERATION)
+	{
+		Operation.Dependencies.Add(CleanupId);
+	}
+
+	Operation.Start = [this, MaxResult, Filter](FLobbyOperation& Op)
+	{
+		return PerformFindLobbies(MaxResult, Filter);
+	};
+	Operation.OnComplete = [this, Filter, Generation](const FLobbyOperation& Op)
+	{
+		if (Op.WasCancelled() || !PlannedSearch.bIsActive || PlannedSearch.Generation != Generation)
+		{
+			return;
+		}
+
+		if (Op.Succeeded() && LastSessionSearch.IsValid())
+		{
+			TArray<FLobbyInfo> FoundLobbies;
+			CollectSearchResults(Filter, FoundLobbies);
+
+			const int32 LocalBuildVersion = static_cast<int32>(FNetworkVersion::GetLocalNetworkVersion());
+			for (FLobbyInfo& Lobby : FoundLobbies)
+			{
+				bool bAlreadyFound = false;
+				PlannedSearch.LobbyIds.Add(Lobby.LobbyId, &bAlreadyFound);
+				if (bAlreadyFound)
+				{
+					continue;
+				}
+
+				if (PlannedSearch.Plan.Ranking.IsEligible(Lobby, LocalBuildVersion))
+				{
+					++PlannedSearch.EligibleCount;
+				}
+				PlannedSearch.Lobbies.Add(MoveTemp(Lobby));
+			}
+		}
+		else
+		{
+			++PlannedSearch.FailedQueries;
+		}
+
+		const int32 EnoughCandidates = PlannedSearch.Plan.EnoughCandidates;
+		const bool bHasEnough = EnoughCandidates > 0 && PlannedSearch.EligibleCount >= EnoughCandidates;
+		if (bHasEnough || !RunNextPlannedQuery())
+		{
+			FinishPlannedSearch();
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::SetLobbyVisibility(bool bIsPublic, const FString& Password)
+void UMultiplayerSessionsSubsystem::FinishPlannedSearch()
 {
-	if (!IsLobbyHost())
+	PlannedSearch.bIsActive = false;
+
+	UE_LOG(LogTemp, Log, TEXT("Planned search ran %d of %d queries, %d lobbies (%d eligible)"),
+	       PlannedSearch.NextQuery, PlannedSearch.Plan.Queries.Num(),
+	       PlannedSearch.Lobbies.Num(), PlannedSearch.EligibleCount);
+
+	if (PlannedSearch.FailedQueries == PlannedSearch.NextQuery)
 	{
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		BroadcastLobbyList(TArray<FLobbyInfo>(), false);
 		return;
 	}
 
-	FLobbyInfo CurrentInfo = GetCurrentLobbyInfo();
+	// Scores are computed once, not per comparison
+	const FQuickJoinPolicy& Ranking = PlannedSearch.Plan.Ranking;
+	const int32 LocalBuildVersion = static_cast<int32>(FNetworkVersion::GetLocalNetworkVersion());
 
-	FLobbySettings NewSettings;
-	NewSettings.MaxPlayers = CurrentInfo.MaxPlayerCount;
-	NewSettings.bIsPublic = bIsPublic;
-	NewSettings.Password = Password;
+	struct FRankedLobby
+	{
+		int32 Index;
+		bool bIsEligible;
+		float Score;
+	};
+	TArray<FRankedLobby> Ranked;
+	Ranked.Reserve(PlannedSearch.Lobbies.Num());
+	for (int32 Index = 0; Index < PlannedSearch.Lobbies.Num(); ++Index)
+	{
+		const FLobbyInfo& Lobby = PlannedSearch.Lobbies[Index];
+		Ranked.Add({Index, Ranking.IsEligible(Lobby, LocalBuildVersion), Ranking.Score(Lobby)});
+	}
 
-	UpdateLobbySettings(NewSettings);
+	Ranked.StableSort([](const FRankedLobby& A, const FRankedLobby& B)
+	{
+		if (A.bIsEligible != B.bIsEligible)
+		{
+			return A.bIsEligible;
+		}
+		return A.Score > B.Score;
+	});
+
+	TArray<FLobbyInfo> Lobbies;
+	Lobbies.Reserve(Ranked.Num());
+	for (const FRankedLobby& Entry : Ranked)
+	{
+		Lobbies.Add(MoveTemp(PlannedSearch.Lobbies[Entry.Index]));
+	}
+	PlannedSearch.Lobbies.Empty();
+	PlannedSearch.LobbyIds.Empty();
+
+	MergeFriendLobbies(Lobbies);
+	ValidateLobbyHistory(Lobbies);
+	LastLobbyListPolicy = Ranking;
+	BroadcastLobbyList(Lobbies, true);
 }
 
-void UMultiplayerSessionsSubsystem::KickPlayer(const FString& PlayerId, const FString& Reason)
+void UMultiplayerSessionsSubsystem::FindFriendLobbies()
 {
 	if (!SessionInterface.IsValid())
 	{
 		return;
 	}
 
-	if (!IsLobbyHost())
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer)
 	{
 		return;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (!Session)
+	// One friend search at a time, the one in flight will merge fresh results
+	if (Scheduler.HasOutstanding(ELobbyOperationType::FindFriends))
 	{
 		return;
 	}
 
-	// Find the player in registered players
-	FUniqueNetIdPtr FoundPlayerId = nullptr;
-	for (const FUniqueNetIdRef& RegisteredId : Session->RegisteredPlayers)
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::FindFriends;
+	Operation.LocalUserNum = LocalPlayer->GetControllerId();
+	Operation.Start = [this](FLobbyOperation& Op)
 	{
-		if (RegisteredId->ToString() == PlayerId)
+		IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
+		IOnlineFriendsPtr FriendsInterface = Subsystem ? Subsystem->GetFriendsInterface() : nullptr;
+		if (!FriendsInterface.IsValid())
 		{
-			FoundPlayerId = RegisteredId;
-			break;
+			return false;
 		}
-	}
 
-	// Player not found in session
-	if (!FoundPlayerId.IsValid())
+		// Friend sessions are looked up once the friends list is known
+		FriendSearchResults.Reset();
+		return FriendsInterface->ReadFriendsList(
+			Op.LocalUserNum, EFriendsLists::ToString(EFriendsLists::Default),
+			FOnReadFriendsListComplete::CreateUObject(this, &ThisClass::OnReadFriendsListComplete, Op.Id));
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
 	{
-		return;
-	}
+		if (Op.WasCancelled())
+		{
+			return;
+		}
 
-	// Don't allow kicking yourself
+		// The search results still stand without friends
+		if (!Op.Succeeded())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Friend lobby search failed"));
+			return;
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		FriendLobbies.Reset(FriendSearchResults.Num());
+		for (const FOnlineSessionSearchResult& SearchResult : FriendSearchResults)
+		{
+			if (!SearchResult.IsValid())
+			{
+				continue;
+			}
+
+			// Cached like a search result so JoinLobby can validate and join it
+			FLobbyInfo& LobbyInfo = FriendLobbies.AddDefaulted_GetRef();
+			FLobbySearchResultConverter::ConvertResult(SearchResult, LobbyInfo);
+			LobbyInfo.bIsFriendLobby = true;
+			SearchCache.Add(SearchResult, LobbyInfo, Now);
+		}
+		FriendSearchResults.Empty();
+
+		UE_LOG(LogTemp, Log, TEXT("Found %d friend lobbies"), FriendLobbies.Num());
+
+		// Lobbies flagged by the previous friend search are re-flagged or dropped by the merge
+		TArray<FLobbyInfo> Lobbies = LastLobbyList;
+		Lobbies.RemoveAll([](const FLobbyInfo& Lobby) { return Lobby.bIsFriendLobby; });
+		MergeFriendLobbies(Lobbies);
+		BroadcastLobbyList(Lobbies, true);
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::MergeFriendLobbies(TArray<FLobbyInfo>& Lobbies)
+{
+	// Friend lobbies go stale like any other cached lobby
+	const double Now = FPlatformTime::Seconds();
+	FriendLobbies.RemoveAll([this, Now](const FLobbyInfo& Lobby) { return !SearchCache.Find(Lobby.LobbyId, Now); });
+
+	if (FriendLobbies.Num() == 0)
+	{
+		return;
+	}
+
+	TMap<FString, int32> LobbyIndices;
+	LobbyIndices.Reserve(Lobbies.Num());
+	for (int32 Index = 0; Index < Lobbies.Num(); ++Index)
+	{
+		LobbyIndices.Add(Lobbies[Index].LobbyId, Index);
+	}
+
+	for (const FLobbyInfo& FriendLobby : FriendLobbies)
+	{
+		if (const int32* Index = LobbyIndices.Find(FriendLobby.LobbyId))
+		{
+			Lobbies[*Index].bIsFriendLobby = true;
+		}
+		else
+		{
+			Lobbies.Add(FriendLobby);
+		}
+	}
+
+	Lobbies.StableSort([](const FLobbyInfo& A, const FLobbyInfo& B)
+	{
+		return A.bIsFriendLobby && !B.bIsFriendLobby;
+	});
+}
+
+void UMultiplayerSessionsSubsystem::CancelFindLobbies()
+{
+	// No more pages or planned queries are wanted either
+	PagedSearch.bIsActive = false;
+	PlannedSearch.bIsActive = false;
+
+	Scheduler.Cancel(ELobbyOperationType::Find);
+	Scheduler.Cancel(ELobbyOperationType::FindFriends);
+}
+
+void UMultiplayerSessionsSubsystem::StartLobbyBrowsing(int32 MaxResult, const FLobbySearchFilter& Filter)
+{
+	if (!bEnableBackgroundBrowse)
+	{
+		return;
+	}
+
+	LobbyBrowse.bIsActive = true;
+	LobbyBrowse.MaxResults = MaxResult;
+	LobbyBrowse.Filter = Filter;
+	LobbyBrowse.Interval = BrowseMinInterval;
+
+	RefreshLobbyBrowse();
+}
+
+void UMultiplayerSessionsSubsystem::StopLobbyBrowsing()
+{
+	LobbyBrowse.bIsActive = false;
+
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance)
+	{
+		GameInstance->GetTimerManager().ClearTimer(LobbyBrowse.RefreshTimer);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::WarmUpLobbySearch(int32 MaxResult, const FLobbySearchFilter& Filter)
+{
+	if (!bEnableBackgroundBrowse)
+	{
+		return;
+	}
+
+	FindLobbies(MaxResult, Filter);
+}
+
+void UMultiplayerSessionsSubsystem::RefreshLobbyBrowse()
+{
+	if (!LobbyBrowse.bIsActive)
+	{
+		return;
+	}
+
+	// Keep polling, but never compete with a join or search from the player
+	if (!IsInLobby() &&
+		!Scheduler.HasOutstanding(ELobbyOperationType::Join) &&
+		!Scheduler.HasOutstanding(ELobbyOperationType::Find))
+	{
+		FindLobbies(LobbyBrowse.MaxResults, LobbyBrowse.Filter);
+	}
+
+	// Fallback if no backend search completes (e.g. answered from a fresh cache)
+	ScheduleLobbyBrowseRefresh();
+}
+
+void UMultiplayerSessionsSubsystem::ScheduleLobbyBrowseRefresh()
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (!LobbyBrowse.bIsActive || !GameInstance)
+	{
+		return;
+	}
+
+	GameInstance->GetTimerManager().SetTimer(LobbyBrowse.RefreshTimer, this, &ThisClass::RefreshLobbyBrowse,
+	                                         FMath::Max(LobbyBrowse.Interval, 1.f), false);
+}
+
+void UMultiplayerSessionsSubsystem::HandleLobbyBrowseResult(bool bResultsChanged)
+{
+	if (!LobbyBrowse.bIsActive)
+	{
+		return;
+	}
+
+	// Quiet lists are polled less and less often, any change snaps back to the fastest rate
+	LobbyBrowse.Interval = bResultsChanged
+		                       ? BrowseMinInterval
+		                       : FMath::Min(LobbyBrowse.Interval * BrowseBackoffMultiplier, BrowseMaxInterval);
+
+	ScheduleLobbyBrowseRefresh();
+}
+
+FLobbyOperationId UMultiplayerSessionsSubsystem::ScheduleStaleSessionCleanup()
+{
+	// A prepared lobby is only wanted while the host is still on the form
+	if (PreparedLobby.bIsActive)
+	{
+		PreparedLobby.bIsActive = false;
+		UE_LOG(LogTemp, Log, TEXT("Dropping prepared lobby session before search or join"));
+		return ScheduleSessionCleanup(NAME_GameSession);
+	}
+
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer || !SessionInterface.IsValid())
+	{
+		return INVALID_LOBBY_OPERATION;
+	}
+
+	// If we're not the host of an existing session, destroy it before searching
+	FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
+	if (!ExistingSession)
+	{
+		return INVALID_LOBBY_OPERATION;
+	}
+
+	// Check if we own this session (we're the host)
+	FUniqueNetIdRepl LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
+	bool bIsHost = ExistingSession->OwningUserId.IsValid() &&
+		LocalPlayerId.IsValid() &&
+		*LocalPlayerId == *ExistingSession->OwningUserId;
+
+	if (bIsHost)
+	{
+		return INVALID_LOBBY_OPERATION;
+	}
+
+	// We have a stale client session - clean it up before searching
+	UE_LOG(LogTemp, Warning, TEXT("Found stale client session before search, cleaning up..."));
+	return ScheduleSessionCleanup(NAME_GameSession);
+}
+
+void UMultiplayerSessionsSubsystem::FindLobbiesPaged(int32 PageSize, const FLobbySearchFilter& Filter)
+{
+	if (!SessionInterface.IsValid())
+	{
+		MultiplayerOnLobbyPageReceived.Broadcast(TArray<FLobbyInfo>(), false, false);
+		return;
+	}
+
+	// Results of a previous paged search still in flight are ignored by generation
+	const uint32 Generation = PagedSearch.Generation + 1;
+	PagedSearch = FLobbyPagedSearch();
+	PagedSearch.bIsActive = true;
+	PagedSearch.Generation = Generation;
+	PagedSearch.PageSize = FMath::Max(1, PageSize);
+	PagedSearch.Filter = Filter;
+	PagedSearch.Demand = PagedSearch.PageSize;
+	PagedSearch.CleanupId = ScheduleStaleSessionCleanup();
+
+	// Seed the first batch from the cache so it doesn't wait for the backend
+	const double Now = FPlatformTime::Seconds();
+	SearchCache.SetTimeToLive(SearchCacheTimeToLive);
+	SearchCache.Prune(Now);
+
+	TArray<FLobbyInfo> CachedLobbies;
+	SearchCache.GetLobbies(CachedLobbies, Now);
+	EnqueuePagedLobbies(CachedLobbies);
+
+	PumpPagedSearch();
+}
+
+void UMultiplayerSessionsSubsystem::RequestNextLobbyPage()
+{
+	if (!PagedSearch.bIsActive || !HasMoreLobbyPages())
+	{
+		return;
+	}
+
+	PagedSearch.Demand += PagedSearch.PageSize;
+	PumpPagedSearch();
+}
+
+bool UMultiplayerSessionsSubsystem::HasMoreLobbyPages() const
+{
+	return PagedSearch.bIsActive &&
+		(PagedSearch.QueuedLobbies.Num() > 0 || !PagedSearch.bBackendExhausted);
+}
+
+int32 UMultiplayerSessionsSubsystem::EnqueuePagedLobbies(const TArray<FLobbyInfo>& Lobbies)
+{
+	int32 NumQueued = 0;
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		if (!PagedSearch.Filter.Matches(Lobby))
+		{
+			continue;
+		}
+
+		bool bAlreadyDelivered = false;
+		PagedSearch.DeliveredLobbyIds.Add(Lobby.LobbyId, &bAlreadyDelivered);
+		if (!bAlreadyDelivered)
+		{
+			PagedSearch.QueuedLobbies.Add(Lobby);
+			++NumQueued;
+		}
+	}
+	return NumQueued;
+}
+
+void UMultiplayerSessionsSubsystem::PumpPagedSearch()
+{
+	// Deliver whatever is already available
+	if (PagedSearch.Demand > 0 && PagedSearch.QueuedLobbies.Num() > 0)
+	{
+		const int32 BatchSize = FMath::Min(PagedSearch.Demand, PagedSearch.QueuedLobbies.Num());
+		TArray<FLobbyInfo> Batch(PagedSearch.QueuedLobbies.GetData(), BatchSize);
+		PagedSearch.QueuedLobbies.RemoveAt(0, BatchSize);
+		PagedSearch.Demand -= BatchSize;
+
+		MultiplayerOnLobbyPageReceived.Broadcast(Batch, HasMoreLobbyPages(), true);
+	}
+
+	// The first search always runs to validate cached lobbies
+	const bool bNeedsMore = PagedSearch.Demand > 0 || !PagedSearch.bHasSearched;
+	if (!bNeedsMore || PagedSearch.bIsSearching || PagedSearch.bBackendExhausted)
+	{
+		return;
+	}
+
+	// Grow the query one page at a time, a small first query returns the fastest
+	PagedSearch.RequestedResults = FMath::Max(
+		PagedSearch.RequestedResults + PagedSearch.PageSize,
+		PagedSearch.DeliveredLobbyIds.Num() + PagedSearch.Demand);
+	PagedSearch.bIsSearching = true;
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Find;
+
+	// Only the first search can overlap the cleanup, later pages are requested after it answered
+	if (PagedSearch.CleanupId != INVALID_LOBBY_OPERATION)
+	{
+		Operation.Dependencies.Add(PagedSearch.CleanupId);
+		PagedSearch.CleanupId = INVALID_LOBBY_OPERATION;
+	}
+
+	Operation.Start = [this, MaxResult = PagedSearch.RequestedResults, Filter = PagedSearch.Filter](FLobbyOperation& Op)
+	{
+		return PerformFindLobbies(MaxResult, Filter);
+	};
+	Operation.OnComplete = [this, Generation = PagedSearch.Generation](const FLobbyOperation& Op)
+	{
+		HandlePagedSearchComplete(Op.Succeeded(), Generation);
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::HandlePagedSearchComplete(bool bWasSuccessful, uint32 Generation)
+{
+	if (!PagedSearch.bIsActive || PagedSearch.Generation != Generation)
+	{
+		return;
+	}
+
+	PagedSearch.bIsSearching = false;
+	PagedSearch.bHasSearched = true;
+
+	if (!bWasSuccessful || !LastSessionSearch.IsValid())
+	{
+		PagedSearch.bBackendExhausted = true;
+		MultiplayerOnLobbyPageReceived.Broadcast(TArray<FLobbyInfo>(), HasMoreLobbyPages(), false);
+		return;
+	}
+
+	TArray<FLobbyInfo> FoundLobbies;
+	CollectSearchResults(PagedSearch.Filter, FoundLobbies);
+
+	// Fewer results than asked for means the backend has nothing more,
+	// no new lobbies means asking for more is unlikely to help either
+	const int32 NumReturned = LastSessionSearch->SearchResults.Num();
+	const int32 NumNew = EnqueuePagedLobbies(FoundLobbies);
+	if (NumReturned < PagedSearch.RequestedResults || NumNew == 0)
+	{
+		PagedSearch.bBackendExhausted = true;
+	}
+
+	const int32 DemandBefore = PagedSearch.Demand;
+	PumpPagedSearch();
+
+	// Nothing left to deliver, tell the consumer the search is over
+	if (PagedSearch.Demand == DemandBefore && !HasMoreLobbyPages())
+	{
+		MultiplayerOnLobbyPageReceived.Broadcast(TArray<FLobbyInfo>(), false, true);
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::PerformFindLobbies(int32 MaxResult, const FLobbySearchFilter& Filter)
+{
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer || !SessionInterface.IsValid())
+	{
+		return false;
+	}
+
+	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
+	LastSessionSearch->MaxSearchResults = MaxResult;
+	LastSessionSearch->bIsLanQuery = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
+
+	// Backends list dedicated servers apart from player hosted lobbies
+	if (bFindDedicatedServerLobbies)
+	{
+		LastSessionSearch->QuerySettings.Set(SEARCH_DEDICATED_ONLY, true, EOnlineComparisonOp::Equals);
+	}
+	else
+	{
+		LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
+	}
+
+	// Let the backend drop lobbies we would discard anyway, so they don't use up MaxResult
+	if (Filter.bOnlyNotFull)
+	{
+		LastSessionSearch->QuerySettings.Set(SEARCH_MINSLOTSAVAILABLE, 1, EOnlineComparisonOp::GreaterThanEquals);
+	}
+	if (Filter.bOnlyPublic)
+	{
+		LobbyAttributes::FIsPublic::Query(LastSessionSearch->QuerySettings, true, EOnlineComparisonOp::Equals);
+	}
+	if (Filter.MinLobbySize > 0)
+	{
+		LobbyAttributes::FMaxPlayers::Query(LastSessionSearch->QuerySettings, Filter.MinLobbySize,
+		                                    EOnlineComparisonOp::GreaterThanEquals);
+	}
+	if (Filter.MaxLobbySize > 0)
+	{
+		LobbyAttributes::FMaxPlayers::Query(LastSessionSearch->QuerySettings, Filter.MaxLobbySize,
+		                                    EOnlineComparisonOp::LessThanEquals);
+	}
+
+	// Packed metadata has no separate keys to query, those lobbies are filtered client side
+	if (!bPackLobbyMetadata)
+	{
+		if (!Filter.GameMode.IsEmpty())
+		{
+			LobbyAttributes::FGameMode::Query(LastSessionSearch->QuerySettings, Filter.GameMode,
+			                                  EOnlineComparisonOp::Equals);
+		}
+		if (!Filter.Region.IsEmpty())
+		{
+			LobbyAttributes::FRegion::Query(LastSessionSearch->QuerySettings, Filter.Region,
+			                                EOnlineComparisonOp::Equals);
+		}
+		if (Filter.BuildVersion != 0)
+		{
+			LobbyAttributes::FBuildVersion::Query(LastSessionSearch->QuerySettings, Filter.BuildVersion,
+			                                      EOnlineComparisonOp::Equals);
+		}
+	}
+
+	return SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(),
+	                                      LastSessionSearch.ToSharedRef());
+}
+
+void UMultiplayerSessionsSubsystem::JoinLobby(const FLobbyInfo& LobbyInfo, const FString& Password,
+                                              bool bTravelOnJoin)
+{
+	if (IsJoiningLobby())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Join already in progress, ignoring join of %s"), *LobbyInfo.LobbyId);
+		return;
+	}
+
+	JoinPipeline = FJoinPipeline();
+	JoinPipeline.bIsActive = true;
+	JoinPipeline.bTravelOnJoin = bTravelOnJoin;
+
+	if (!SessionInterface.IsValid())
+	{
+		FinishLobbyJoin(ELobbyJoinResult::UnknownError);
+		return;
+	}
+
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (!LocalPlayer)
+	{
+		FinishLobbyJoin(ELobbyJoinResult::UnknownError);
+		return;
+	}
+
+	const FLobbySearchCacheEntry* CachedLobby = SearchCache.Find(LobbyInfo.LobbyId, FPlatformTime::Seconds());
+	if (!CachedLobby)
+	{
+		FinishLobbyJoin(ELobbyJoinResult::LobbyNotFound);
+		return;
+	}
+
+	const FOnlineSessionSearchResult* FoundResult = &CachedLobby->SearchResult;
+
+	if (FoundResult->Session.NumOpenPublicConnections <= 0)
+	{
+		FinishLobbyJoin(ELobbyJoinResult::LobbyFull);
+		return;
+	}
+
+	bool bInProgress = false;
+	if (LobbyAttributes::FInProgress::Get(FoundResult->Session.SessionSettings, bInProgress) && bInProgress)
+	{
+		FinishLobbyJoin(ELobbyJoinResult::MatchInProgress);
+		return;
+	}
+
+	bool bIsPublic = true;
+	LobbyAttributes::FIsPublic::Get(FoundResult->Session.SessionSettings, bIsPublic);
+
+	// Password Validation
+	if (!bIsPublic)
+	{
+		FString StoredHash;
+		LobbyAttributes::FPasswordHash::Get(FoundResult->Session.SessionSettings, StoredHash);
+
+		if (!ValidatePassword(Password, StoredHash))
+		{
+			FinishLobbyJoin(ELobbyJoinResult::WrongPassword);
+			return;
+		}
+	}
+
+	// Lobbies of the search the selection came from to fall back on if this one cannot be joined or reached,
+	// ranked with that search's filter. Friend lobbies skip the filter, so they are never a fallback.
+	const bool bIsListed = LastLobbyList.ContainsByPredicate(
+		[&LobbyInfo](const FLobbyInfo& Lobby) { return Lobby.LobbyId == LobbyInfo.LobbyId; });
+	if (MaxJoinFallbacks > 0 && bIsListed && !bLobbyListIsStale)
+	{
+		TArray<FLobbyInfo> Fallbacks = LastLobbyList;
+		Fallbacks.RemoveAll([&LobbyInfo](const FLobbyInfo& Lobby)
+		{
+			return Lobby.bIsFriendLobby || Lobby.LobbyId == LobbyInfo.LobbyId;
+		});
+
+		JoinPipeline.Policy = LastLobbyListPolicy;
+		JoinPipeline.Policy.MaxJoinAttempts = MaxJoinFallbacks;
+		RankJoinCandidates(Fallbacks);
+	}
+
+	JoinPipeline.CurrentLobbyId = LobbyInfo.LobbyId;
+	JoinSearchResult(*FoundResult, LobbyInfo.LobbyId);
+}
+
+void UMultiplayerSessionsSubsystem::JoinLobbyById(const FString& LobbyId, const FString& Password,
+                                                  bool bTravelOnJoin)
+{
+	// The pipeline only becomes active once the lobby is resolved, an outstanding resolve is a join too
+	if (IsJoiningLobby() || Scheduler.HasOutstanding(ELobbyOperationType::FindById))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Join already in progress, ignoring join of %s"), *LobbyId);
+		return;
+	}
+
+	if (!SessionInterface.IsValid())
+	{
+		BroadcastLobbyJoinComplete(ELobbyJoinResult::UnknownError);
+		return;
+	}
+
+	// Seen in a recent search, nothing to resolve
+	const FLobbySearchCacheEntry* CachedLobby = SearchCache.Find(LobbyId, FPlatformTime::Seconds());
+	if (CachedLobby)
+	{
+		JoinLobby(CachedLobby->LobbyInfo, Password, bTravelOnJoin);
+		return;
+	}
+
+	ResolveLobbyById(LobbyId, [this, Password, bTravelOnJoin](const FLobbyInfo* LobbyInfo)
+	{
+		if (!LobbyInfo)
+		{
+			BroadcastLobbyJoinComplete(ELobbyJoinResult::LobbyNotFound);
+			return;
+		}
+
+		JoinLobby(*LobbyInfo, Password, bTravelOnJoin);
+	});
+}
+
+bool UMultiplayerSessionsSubsystem::JoinLobbyFromLink(const FString& Link)
+{
+	// Query strings and command lines share the key=value form
+	FString Options = Link;
+	Options.ReplaceCharInline(TEXT('?'), TEXT(' '));
+	Options.ReplaceCharInline(TEXT('&'), TEXT(' '));
+
+	FString LobbyId;
+	if (!FParse::Value(*Options, TEXT("lobby="), LobbyId) || LobbyId.IsEmpty())
+	{
+		return false;
+	}
+
+	PendingLinkJoin.LobbyId = LobbyId;
+	PendingLinkJoin.Password.Empty();
+	FParse::Value(*Options, TEXT("lobbypassword="), PendingLinkJoin.Password);
+
+	StartPendingLinkJoin();
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::IsJoiningFromLink() const
+{
+	return !PendingLinkJoin.LobbyId.IsEmpty() || bIsJoiningFromLink;
+}
+
+void UMultiplayerSessionsSubsystem::BroadcastLobbyJoinComplete(ELobbyJoinResult Result)
+{
+	// Every join, including the link join's id resolve, ends with exactly one result
+	bIsJoiningFromLink = false;
+	MultiplayerOnLobbyJoinComplete.Broadcast(Result);
+}
+
+void UMultiplayerSessionsSubsystem::StartPendingLinkJoin()
+{
+	if (PendingLinkJoin.LobbyId.IsEmpty())
+	{
+		return;
+	}
+
+	// On startup there is no local player until the first map has loaded
+	UWorld* World = GetWorld();
+	if (!World || !World->GetFirstLocalPlayerFromController())
+	{
+		return;
+	}
+
+	const FPendingLinkJoin LinkJoin = MoveTemp(PendingLinkJoin);
+	PendingLinkJoin = FPendingLinkJoin();
+
+	UE_LOG(LogTemp, Log, TEXT("Joining lobby %s from link"), *LinkJoin.LobbyId);
+	bIsJoiningFromLink = true;
+	JoinLobbyById(LinkJoin.LobbyId, LinkJoin.Password, true);
+}
+
+void UMultiplayerSessionsSubsystem::ResolveLobbyById(const FString& LobbyId,
+                                                     TFunction<void(const FLobbyInfo*)> OnResolved)
+{
+	TSharedRef<FOnlineSessionSearchResult> Result = MakeShared<FOnlineSessionSearchResult>();
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::FindById;
+
+	// A stale client session would make the following join fail
+	const FLobbyOperationId CleanupId = ScheduleStaleSessionCleanup();
+	if (CleanupId != INVALID_LOBBY_OPERATION)
+	{
+		Operation.Dependencies.Add(CleanupId);
+	}
+
+	Operation.Start = [this, LobbyId, Result](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		const FUniqueNetIdRepl LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
+		const FUniqueNetIdPtr SessionId = SessionInterface->CreateSessionIdFromString(LobbyId);
+		if (!LocalPlayerId.IsValid() || !SessionId.IsValid())
+		{
+			return false;
+		}
+
+		return SessionInterface->FindSessionById(
+			*LocalPlayerId, *SessionId, *LocalPlayerId,
+			FOnSingleSessionResultCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnFindSessionByIdComplete, Op.Id, Result));
+	};
+	Operation.OnComplete = [this, LobbyId, Result, OnResolved = MoveTemp(OnResolved)](const FLobbyOperation& Op)
+	{
+		if (!Op.Succeeded())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not resolve lobby %s"), *LobbyId);
+			if (OnResolved)
+			{
+				OnResolved(nullptr);
+			}
+			return;
+		}
+
+		// Cached like a search result so JoinLobby can validate and join it
+		FLobbyInfo LobbyInfo;
+		FLobbySearchResultConverter::ConvertResult(*Result, LobbyInfo);
+		SearchCache.Add(*Result, LobbyInfo, FPlatformTime::Seconds());
+
+		if (OnResolved)
+		{
+			OnResolved(&LobbyInfo);
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::JoinSearchResult(const FOnlineSessionSearchResult& SearchResult,
+                                                     const FString& LobbyId)
+{
+	// The join chains behind the destroy of a session prepared for hosting
+	CancelPreparedLobby();
+
+	// The search result is copied so cache refreshes cannot invalidate it
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Join;
+	Operation.SessionName = NAME_GameSession;
+	// Reported if the join never reaches the backend
+	Operation.ResultCode = EOnJoinSessionCompleteResult::UnknownError;
+	Operation.Start = [this, SearchResult](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* JoiningPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!JoiningPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		return SessionInterface->JoinSession(*JoiningPlayer->GetPreferredUniqueNetId(),
+		                                     Op.SessionName,
+		                                     SearchResult);
+	};
+	Operation.OnComplete = [this, LobbyId](const FLobbyOperation& Op)
+	{
+		HandleLobbyJoinComplete(static_cast<EOnJoinSessionCompleteResult::Type>(Op.ResultCode), LobbyId,
+		                        Op.TimedOut());
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::QuickJoin(const FQuickJoinPolicy& Policy)
+{
+	if (IsJoiningLobby())
+	{
+		return;
+	}
+
+	if (!SessionInterface.IsValid() || !GetWorld()->GetFirstLocalPlayerFromController())
+	{
+		BroadcastLobbyJoinComplete(ELobbyJoinResult::UnknownError);
+		return;
+	}
+
+	JoinPipeline = FJoinPipeline();
+	JoinPipeline.bIsActive = true;
+	JoinPipeline.Policy = Policy;
+	JoinPipeline.Policy.Filter.bOnlyNotFull = true;
+	JoinPipeline.Policy.Filter.bOnlyPublic = true;
+
+	// A fresh cache is as good as a new search and saves a backend round trip
+	const double Now = FPlatformTime::Seconds();
+	SearchCache.SetTimeToLive(SearchCacheTimeToLive);
+	SearchCache.Prune(Now);
+
+	if (SearchCache.HasRefreshed() && SearchCache.GetAge(Now) < SearchCacheFreshPeriod)
+	{
+		TArray<FLobbyInfo> CachedLobbies;
+		SearchCache.GetLobbies(CachedLobbies, Now);
+		RankJoinCandidates(CachedLobbies);
+
+		if (!TryNextJoinCandidate())
+		{
+			FinishLobbyJoin(ELobbyJoinResult::LobbyNotFound);
+		}
+		return;
+	}
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Find;
+
+	const FLobbyOperationId CleanupId = ScheduleStaleSessionCleanup();
+	if (CleanupId != INVALID_LOBBY_OPERATION)
+	{
+		Operation.Dependencies.Add(CleanupId);
+	}
+
+	Operation.Start = [this, MaxResult = JoinPipeline.Policy.MaxSearchResults,
+			Filter = JoinPipeline.Policy.Filter](FLobbyOperation& Op)
+	{
+		return PerformFindLobbies(MaxResult, Filter);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		if (!JoinPipeline.bIsActive)
+		{
+			return;
+		}
+
+		if (!Op.Succeeded() || !LastSessionSearch.IsValid())
+		{
+			FinishLobbyJoin(ELobbyJoinResult::UnknownError);
+			return;
+		}
+
+		TArray<FLobbyInfo> FoundLobbies;
+		CollectSearchResults(JoinPipeline.Policy.Filter, FoundLobbies);
+		RankJoinCandidates(FoundLobbies);
+
+		if (!TryNextJoinCandidate())
+		{
+			FinishLobbyJoin(ELobbyJoinResult::LobbyNotFound);
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::RankJoinCandidates(const TArray<FLobbyInfo>& Lobbies)
+{
+	const FQuickJoinPolicy& Policy = JoinPipeline.Policy;
+	const int32 LocalBuildVersion = static_cast<int32>(FNetworkVersion::GetLocalNetworkVersion());
+	const double Now = FPlatformTime::Seconds();
+
+	JoinPipeline.Candidates.Reset();
+	JoinPipeline.NextCandidate = 0;
+
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		if (!Policy.IsEligible(Lobby, LocalBuildVersion))
+		{
+			continue;
+		}
+
+		// Candidates keep their own search result, a failed attempt may reset the cache
+		const FLobbySearchCacheEntry* CachedLobby = SearchCache.Find(Lobby.LobbyId, Now);
+		if (!CachedLobby)
+		{
+			continue;
+		}
+
+		// Closed for a match since it was listed, like JoinLobby the join would only fail
+		bool bInProgress = false;
+		if (LobbyAttributes::FInProgress::Get(CachedLobby->SearchResult.Session.SessionSettings, bInProgress) &&
+			bInProgress)
+		{
+			continue;
+		}
+
+		FJoinCandidate& Candidate = JoinPipeline.Candidates.AddDefaulted_GetRef();
+		Candidate.LobbyInfo = Lobby;
+		Candidate.SearchResult = CachedLobby->SearchResult;
+		Candidate.Score = Policy.Score(Lobby);
+	}
+
+	JoinPipeline.Candidates.StableSort([](const FJoinCandidate& A, const FJoinCandidate& B)
+	{
+		return A.Score > B.Score;
+	});
+
+	const int32 MaxCandidates = FMath::Max(1, Policy.MaxJoinAttempts);
+	if (JoinPipeline.Candidates.Num() > MaxCandidates)
+	{
+		JoinPipeline.Candidates.SetNum(MaxCandidates);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Ranked %d of %d lobbies as join candidates"), JoinPipeline.Candidates.Num(), Lobbies.Num());
+}
+
+bool UMultiplayerSessionsSubsystem::TryNextJoinCandidate()
+{
+	if (!JoinPipeline.bIsActive || !JoinPipeline.Candidates.IsValidIndex(JoinPipeline.NextCandidate))
+	{
+		return false;
+	}
+
+	// Copied, the join may finish synchronously and re-enter here
+	const FJoinCandidate Candidate = JoinPipeline.Candidates[JoinPipeline.NextCandidate++];
+	UE_LOG(LogTemp, Log, TEXT("Join candidate %d: %s (score %.2f)"),
+	       JoinPipeline.NextCandidate, *Candidate.LobbyInfo.LobbyId, Candidate.Score);
+
+	// A failed attempt can leave its session behind, the next join chains behind the cleanup
+	if (SessionInterface.IsValid() && SessionInterface->GetNamedSession(NAME_GameSession))
+	{
+		ScheduleSessionCleanup(NAME_GameSession);
+	}
+
+	JoinPipeline.CurrentLobbyId = Candidate.LobbyInfo.LobbyId;
+	JoinSearchResult(Candidate.SearchResult, Candidate.LobbyInfo.LobbyId);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::FinishLobbyJoin(ELobbyJoinResult Result)
+{
+	if (Result != ELobbyJoinResult::Success && JoinPipeline.bIsActive && TryNextJoinCandidate())
+	{
+		return;
+	}
+
+	// Stay active after a successful join so a failed travel can still fall back
+	if (Result == ELobbyJoinResult::Success && JoinPipeline.bIsActive)
+	{
+		JoinPipeline.bJoined = true;
+		if (JoinPipeline.bTravelOnJoin)
+		{
+			TravelToJoinedLobby();
+		}
+	}
+	else
+	{
+		JoinPipeline.bIsActive = false;
+	}
+
+	BroadcastLobbyJoinComplete(Result);
+}
+
+bool UMultiplayerSessionsSubsystem::TravelToJoinedLobby()
+{
+	// Fallback joins travel by themselves, the menu may ask again for the same lobby
+	if (JoinPipeline.bTravelPending)
+	{
+		return true;
+	}
+
+	UGameInstance* GameInstance = GetGameInstance();
+	APlayerController* PlayerController = GameInstance ? GameInstance->GetFirstLocalPlayerController() : nullptr;
+	if (!PlayerController)
+	{
+		return false;
+	}
+
+	if (CachedConnectAddress.IsEmpty())
+	{
+		HandleJoinTravelFailure(TEXT("No connect address"));
+		return false;
+	}
+
+	JoinPipeline.bTravelPending = JoinPipeline.bIsActive;
+	PlayerController->ClientTravel(CachedConnectAddress, ETravelType::TRAVEL_Absolute);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::HandleJoinTravelFailure(const FString& Reason)
+{
+	if (!JoinPipeline.bIsActive || !JoinPipeline.bJoined)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Could not reach lobby %s (%s), trying the next candidate"),
+	       *JoinPipeline.CurrentLobbyId, *Reason);
+
+	JoinPipeline.bJoined = false;
+	JoinPipeline.bTravelPending = false;
+	SearchCache.Remove(JoinPipeline.CurrentLobbyId);
+	CleanupAfterFailedJoin();
+
+	// The engine is still tearing the failed connection down, join again once it is done
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance)
+	{
+		GameInstance->GetTimerManager().SetTimerForNextTick(this, &ThisClass::RetryJoinAfterTravelFailure);
+	}
+	else
+	{
+		RetryJoinAfterTravelFailure();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::RetryJoinAfterTravelFailure()
+{
+	if (!JoinPipeline.bIsActive)
+	{
+		return;
+	}
+
+	JoinPipeline.bTravelOnJoin = true;
+	FinishLobbyJoin(ELobbyJoinResult::ConnectionFailed);
+}
+
+void UMultiplayerSessionsSubsystem::OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType,
+                                                    const FString& ErrorString)
+{
+	if (JoinPipeline.bTravelPending)
+	{
+		HandleJoinTravelFailure(FString::Printf(TEXT("%s: %s"), ETravelFailure::ToString(FailureType), *ErrorString));
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnNetworkFailure(UWorld* World, UNetDriver* NetDriver,
+                                                     ENetworkFailure::Type FailureType, const FString& ErrorString)
+{
+	if (JoinPipeline.bTravelPending)
+	{
+		HandleJoinTravelFailure(FString::Printf(TEXT("%s: %s"), ENetworkFailure::ToString(FailureType), *ErrorString));
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	// Arriving on the host's map as a client ends the join
+	if (JoinPipeline.bTravelPending && LoadedWorld && LoadedWorld->GetNetMode() == NM_Client)
+	{
+		JoinPipeline = FJoinPipeline();
+	}
+
+	StartPendingLinkJoin();
+}
+
+void UMultiplayerSessionsSubsystem::UpdateLobbySettings(const FLobbySettings& NewSettings)
+{
+	if (!SessionInterface.IsValid())
+	{
+		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		return;
+	}
+
+	if (!IsLobbyHost())
+	{
+		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		return;
+	}
+
+	// Settings are complete snapshots, the latest one in the window wins
+	PendingLobbyUpdate.Settings = NewSettings;
+	PendingLobbyUpdate.bHasSettings = true;
+	ScheduleLobbySettingsFlush();
+}
+
+void UMultiplayerSessionsSubsystem::ScheduleLobbySettingsFlush()
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (LobbySettingsUpdateWindow <= 0.f || !GameInstance)
+	{
+		FlushLobbySettingsUpdate();
+		return;
+	}
+
+	FTimerManager& TimerManager = GameInstance->GetTimerManager();
+	if (!TimerManager.IsTimerActive(PendingLobbyUpdate.FlushTimer))
+	{
+		TimerManager.SetTimer(PendingLobbyUpdate.FlushTimer, this, &ThisClass::FlushLobbySettingsUpdate,
+		                      LobbySettingsUpdateWindow, false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::FlushLobbySettingsUpdate()
+{
+	if (!PendingLobbyUpdate.bHasSettings && !PendingLobbyUpdate.bBumpDataVersion)
+	{
+		return;
+	}
+
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance)
+	{
+		GameInstance->GetTimerManager().ClearTimer(PendingLobbyUpdate.FlushTimer);
+	}
+
+	const bool bHasSettings = PendingLobbyUpdate.bHasSettings;
+	const bool bBumpDataVersion = PendingLobbyUpdate.bBumpDataVersion;
+	const FLobbySettings NewSettings = PendingLobbyUpdate.Settings;
+	PendingLobbyUpdate.bHasSettings = false;
+	PendingLobbyUpdate.bBumpDataVersion = false;
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Update;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this, bHasSettings, bBumpDataVersion, NewSettings](FLobbyOperation& Op)
+	{
+		// Read the session when the update runs, earlier updates may have changed it
+		FNamedOnlineSession* Session =
+			SessionInterface.IsValid() ? SessionInterface->GetNamedSession(Op.SessionName) : nullptr;
+		if (!Session)
+		{
+			return false;
+		}
+
+		FOnlineSessionSettings UpdatedSessionSettings = Session->SessionSettings;
+		// Membership changes only need a new DataVersion
+		bool bChanged = bBumpDataVersion;
+
+		if (bHasSettings)
+		{
+			if (UpdatedSessionSettings.NumPublicConnections != NewSettings.MaxPlayers)
+			{
+				UpdatedSessionSettings.NumPublicConnections = NewSettings.MaxPlayers;
+				LobbyAttributes::FMaxPlayers::Set(UpdatedSessionSettings, NewSettings.MaxPlayers);
+				bChanged = true;
+			}
+
+			// Host name and build version carry over from the current metadata
+			FLobbyInfo Metadata;
+			FLobbyMetadataCodec::Read(UpdatedSessionSettings, Metadata);
+			if (Metadata.bIsPublic != NewSettings.bIsPublic ||
+				Metadata.GameMode != NewSettings.GameMode ||
+				Metadata.Region != NewSettings.Region)
+			{
+				Metadata.bIsPublic = NewSettings.bIsPublic;
+				Metadata.GameMode = NewSettings.GameMode;
+				Metadata.Region = NewSettings.Region;
+				FLobbyMetadataCodec::Write(UpdatedSessionSettings, Metadata, bPackLobbyMetadata);
+				bChanged = true;
+			}
+
+			// Public lobbies and empty passwords carry no hash
+			const FString NewPasswordHash = !NewSettings.bIsPublic && !NewSettings.Password.IsEmpty()
+				                                ? HashPassword(NewSettings.Password)
+				                                : FString();
+			FString CurrentPasswordHash;
+			LobbyAttributes::FPasswordHash::Get(UpdatedSessionSettings, CurrentPasswordHash);
+			if (CurrentPasswordHash != NewPasswordHash)
+			{
+				if (NewPasswordHash.IsEmpty())
+				{
+					LobbyAttributes::FPasswordHash::Remove(UpdatedSessionSettings);
+				}
+				else
+				{
+					LobbyAttributes::FPasswordHash::Set(UpdatedSessionSettings, NewPasswordHash);
+				}
+				bChanged = true;
+			}
+		}
+
+		// Nothing to tell the backend
+		if (!bChanged)
+		{
+			Scheduler.Complete(Op.Id, true);
+			return true;
+		}
+
+		FLobbyMetadataCodec::BumpDataVersion(UpdatedSessionSettings);
+		return SessionInterface->UpdateSession(Op.SessionName, UpdatedSessionSettings);
+	};
+	Operation.OnComplete = [this, bHasSettings](const FLobbyOperation& Op)
+	{
+		// A bare DataVersion bump was nobody's settings change
+		if (!bHasSettings)
+		{
+			return;
+		}
+
+		if (Op.Succeeded())
+		{
+			FLobbyInfo UpdatedInfo = CreateLobbyInfoFromSession();
+			MultiplayerOnLobbySettingsUpdated.Broadcast(UpdatedInfo);
+		}
+		else
+		{
+			MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::SetLobbyVisibility(bool bIsPublic, const FString& Password)
+{
+	if (!IsLobbyHost())
+	{
+		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		return;
+	}
+
+	// Build on changes still waiting in the update window, not just on the session
+	FLobbySettings NewSettings;
+	if (PendingLobbyUpdate.bHasSettings)
+	{
+		NewSettings = PendingLobbyUpdate.Settings;
+	}
+	else
+	{
+		FLobbyInfo CurrentInfo = GetCurrentLobbyInfo();
+		NewSettings.MaxPlayers = CurrentInfo.MaxPlayerCount;
+		NewSettings.GameMode = CurrentInfo.GameMode;
+		NewSettings.Region = CurrentInfo.Region;
+	}
+	NewSettings.bIsPublic = bIsPublic;
+	NewSettings.Password = Password;
+
+	UpdateLobbySettings(NewSettings);
+}
+
+void UMultiplayerSessionsSubsystem::KickPlayer(const FString& PlayerId, const FString& Reason)
+{
+	if (!SessionInterface.IsValid())
+	{
+		return;
+	}
+
+	if (!IsLobbyHost())
+	{
+		return;
+	}
+
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	if (!Session)
+	{
+		return;
+	}
+
+	// Find the player in registered players
+	FUniqueNetIdPtr FoundPlayerId = nullptr;
+	for (const FUniqueNetIdRef& RegisteredId : Session->RegisteredPlayers)
+	{
+		if (RegisteredId->ToString() == PlayerId)
+		{
+			FoundPlayerId = RegisteredId;
+			break;
+		}
+	}
+
+	// Player not found in session
+	if (!FoundPlayerId.IsValid())
+	{
+		return;
+	}
+
+	// Don't allow kicking yourself
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
 	if (LocalPlayer)
 	{
-		FUniqueNetIdRepl LocalId = LocalPlayer->GetPreferredUniqueNetId();
-		if (LocalId.IsValid() && *LocalId == *FoundPlayerId)
+		FUniqueNetIdRepl LocalId = LocalPlayer->GetPreferredUniqueNetId();
+		if (LocalId.IsValid() && *LocalId == *FoundPlayerId)
+		{
+			return;
+		}
+	}
+
+	// Cache player info BEFORE they are removed from RegisteredPlayers
+	FLobbyPlayerInfo KickedPlayerInfo;
+	KickedPlayerInfo.PlayerId = PlayerId;
+	KickedPlayerInfo.bIsHost = false;
+
+	IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld());
+	IOnlineIdentityPtr IdentityInterface =
+		OnlineSubsystem ? OnlineSubsystem->GetIdentityInterface() : nullptr;
+
+	if (IdentityInterface.IsValid())
+	{
+		KickedPlayerInfo.PlayerName = IdentityInterface->GetPlayerNickname(*FoundPlayerId);
+	}
+	if (KickedPlayerInfo.PlayerName.IsEmpty())
+	{
+		KickedPlayerInfo.PlayerName = TEXT("Unknown");
+	}
+
+	// Store pending kick data
+	PendingKicks.Add(PlayerId, Reason);
+	PendingKickInfo.Add(PlayerId, KickedPlayerInfo);
+
+	// Unregister the player from the session
+	// This will trigger ONSessionParticipantRemoved on Steam
+	bool bSuccess = SessionInterface->UnregisterPlayer(NAME_GameSession, *FoundPlayerId);
+	if (!bSuccess)
+	{
+		PendingKicks.Remove(PlayerId);
+		PendingKickInfo.Remove(PlayerId);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::TransferHost(const FString& NewHostPlayerId)
+{
+	// TODO: Requires direct Steam API access
+	// Steam's SetLobbyOwner() not exposed through Unreal OSS
+	MultiplayerOnHostMigration.Broadcast(FLobbyPlayerInfo(), FLobbyPlayerInfo());
+}
+
+/* PARTY */
+
+void UMultiplayerSessionsSubsystem::CreateParty(int32 MaxMembers)
+{
+	if (!SessionInterface.IsValid())
+	{
+		MultiplayerOnPartyCreated.Broadcast(false, FLobbyInfo());
+		return;
+	}
+
+	if (SessionInterface->GetNamedSession(NAME_PartySession))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Leaving current party before creating a new one"));
+		ScheduleSessionCleanup(NAME_PartySession);
+	}
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Create;
+	Operation.SessionName = NAME_PartySession;
+	Operation.Start = [this, MaxMembers](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		FLobbySettings PartySettings;
+		PartySettings.MaxPlayers = MaxMembers;
+		PartySettings.bIsPublic = false;
+
+		// Never listed, but reachable through invites and presence
+		TSharedPtr<FOnlineSessionSettings> Settings =
+			MakeLobbySessionSettings(PartySettings, GetLobbyHostName(LocalPlayer), false);
+		Settings->bAllowInvites = true;
+		Settings->bAllowJoinViaPresence = true;
+		LobbyAttributes::FIsParty::Set(*Settings, true);
+
+		return SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), Op.SessionName, *Settings);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		MultiplayerOnPartyCreated.Broadcast(Op.Succeeded(),
+		                                    Op.Succeeded() ? CreateLobbyInfoFromSession(Op.SessionName) : FLobbyInfo());
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::JoinParty(const FOnlineSessionSearchResult& SearchResult)
+{
+	// Accepting a party invite leaves the current party, the join chains behind the destroy
+	if (SessionInterface->GetNamedSession(NAME_PartySession))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Leaving current party for accepted invite"));
+		ScheduleSessionCleanup(NAME_PartySession);
+	}
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Join;
+	Operation.SessionName = NAME_PartySession;
+	Operation.ResultCode = EOnJoinSessionCompleteResult::UnknownError;
+	Operation.Start = [this, SearchResult](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* JoiningPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!JoiningPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		return SessionInterface->JoinSession(*JoiningPlayer->GetPreferredUniqueNetId(), Op.SessionName, SearchResult);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		// A party has no server of its own, joining the session is all there is to it
+		switch (Op.ResultCode)
+		{
+		case EOnJoinSessionCompleteResult::Success:
+			MultiplayerOnPartyJoinComplete.Broadcast(ELobbyJoinResult::Success);
+			break;
+		case EOnJoinSessionCompleteResult::SessionIsFull:
+			MultiplayerOnPartyJoinComplete.Broadcast(ELobbyJoinResult::LobbyFull);
+			break;
+		case EOnJoinSessionCompleteResult::SessionDoesNotExist:
+			MultiplayerOnPartyJoinComplete.Broadcast(ELobbyJoinResult::LobbyNotFound);
+			break;
+		default:
+			MultiplayerOnPartyJoinComplete.Broadcast(Op.TimedOut()
+				                                         ? ELobbyJoinResult::TimedOut
+				                                         : ELobbyJoinResult::ConnectionFailed);
+			break;
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::LeaveParty()
+{
+	LeaveLobby(NAME_PartySession);
+}
+
+/* MATCH LIFECYCLE */
+
+bool UMultiplayerSessionsSubsystem::BeginMatch()
+{
+	if (LobbyLifecycleState != ELobbyLifecycleState::Lobby)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BeginMatch called outside the Lobby state"));
+		return false;
+	}
+
+	if (!SessionInterface.IsValid() || !IsLobbyHost())
+	{
+		return false;
+	}
+
+	// Settings still waiting in the update window land before the lobby closes
+	FlushLobbySettingsUpdate();
+
+	SetLobbyLifecycleState(ELobbyLifecycleState::Starting);
+	UpdateLobbyJoinability(false);
+
+	// Chains behind the joinability update on the same session
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Start;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this](FLobbyOperation& Op)
+	{
+		return SessionInterface.IsValid() && SessionInterface->StartSession(Op.SessionName);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		// Ended or back in the lobby before the backend answered
+		if (LobbyLifecycleState != ELobbyLifecycleState::Starting)
+		{
+			return;
+		}
+
+		// The match runs either way, the lobby just stays closed
+		if (!Op.Succeeded())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not start the lobby session, continuing the match unstarted"));
+		}
+		SetLobbyLifecycleState(ELobbyLifecycleState::InGame);
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::EndMatch()
+{
+	if (LobbyLifecycleState != ELobbyLifecycleState::Starting && LobbyLifecycleState != ELobbyLifecycleState::InGame)
+	{
+		return;
+	}
+
+	SetLobbyLifecycleState(ELobbyLifecycleState::PostGame);
+
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::End;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this](FLobbyOperation& Op)
+	{
+		return SessionInterface.IsValid() && SessionInterface->EndSession(Op.SessionName);
+	};
+	Operation.OnComplete = [](const FLobbyOperation& Op)
+	{
+		if (!Op.Succeeded())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not end the lobby session"));
+		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::ReturnToLobby()
+{
+	if (LobbyLifecycleState == ELobbyLifecycleState::Lobby)
+	{
+		return;
+	}
+
+	// The session may still be running if the match was abandoned
+	EndMatch();
+
+	SetLobbyLifecycleState(ELobbyLifecycleState::Lobby);
+	UpdateLobbyJoinability(true);
+}
+
+void UMultiplayerSessionsSubsystem::SetLobbyLifecycleState(ELobbyLifecycleState NewState)
+{
+	if (LobbyLifecycleState == NewState)
+	{
+		return;
+	}
+
+	LobbyLifecycleState = NewState;
+	MultiplayerOnLobbyLifecycleChanged.Broadcast(NewState);
+}
+
+void UMultiplayerSessionsSubsystem::UpdateLobbyJoinability(bool bJoinable)
+{
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Update;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this, bJoinable](FLobbyOperation& Op)
+	{
+		FNamedOnlineSession* Session =
+			SessionInterface.IsValid() ? SessionInterface->GetNamedSession(Op.SessionName) : nullptr;
+		if (!Session)
+		{
+			return false;
+		}
+
+		// Backends that keep listing non-advertised sessions still carry the in-progress flag
+		FOnlineSessionSettings UpdatedSessionSettings = Session->SessionSettings;
+		if (!bJoinable)
+		{
+			// A repeated close must not record the closed flags as the open ones
+			if (!OpenLobbyJoinability.bIsSet)
+			{
+				OpenLobbyJoinability.bIsSet = true;
+				OpenLobbyJoinability.bShouldAdvertise = UpdatedSessionSettings.bShouldAdvertise;
+				OpenLobbyJoinability.bAllowJoinInProgress = UpdatedSessionSettings.bAllowJoinInProgress;
+				OpenLobbyJoinability.bAllowJoinViaPresence = UpdatedSessionSettings.bAllowJoinViaPresence;
+			}
+			UpdatedSessionSettings.bShouldAdvertise = false;
+			UpdatedSessionSettings.bAllowJoinInProgress = false;
+			UpdatedSessionSettings.bAllowJoinViaPresence = false;
+		}
+		else if (OpenLobbyJoinability.bIsSet)
+		{
+			// Dedicated server lobbies were never joinable through presence, they stay that way
+			UpdatedSessionSettings.bShouldAdvertise = OpenLobbyJoinability.bShouldAdvertise;
+			UpdatedSessionSettings.bAllowJoinInProgress = OpenLobbyJoinability.bAllowJoinInProgress;
+			UpdatedSessionSettings.bAllowJoinViaPresence = OpenLobbyJoinability.bAllowJoinViaPresence;
+			OpenLobbyJoinability = FLobbyJoinability();
+		}
+		LobbyAttributes::FInProgress::Set(UpdatedSessionSettings, !bJoinable);
+		FLobbyMetadataCodec::BumpDataVersion(UpdatedSessionSettings);
+		return SessionInterface->UpdateSession(Op.SessionName, UpdatedSessionSettings);
+	};
+	Operation.OnComplete = [bJoinable](const FLobbyOperation& Op)
+	{
+		if (!Op.Succeeded())
 		{
-			return;
+			UE_LOG(LogTemp, Warning, TEXT("Could not %s the lobby"), bJoinable ? TEXT("reopen") : TEXT("close"));
 		}
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+/* OPERATIONS */
+
+void UMultiplayerSessionsSubsystem::BindOperationDelegate(FLobbyOperation& Operation)
+{
+	if (!SessionInterface.IsValid())
+	{
+		return;
 	}
 
-	// Cache player info BEFORE they are removed from RegisteredPlayers
-	FLobbyPlayerInfo KickedPlayerInfo;
-	KickedPlayerInfo.PlayerId = PlayerId;
-	KickedPlayerInfo.bIsHost = false;
+	switch (Operation.Type)
+	{
+	case ELobbyOperationType::Create:
+		Operation.CompletionHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(
+			FOnCreateSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnCreateSessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::Find:
+		Operation.CompletionHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(
+			FOnFindSessionsCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnFindSessionsComplete, Operation.Id));
+		if (AbandonedSearch.bIsPending)
+		{
+			DeferSearchStart(Operation);
+		}
+		break;
+	case ELobbyOperationType::Join:
+		Operation.CompletionHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(
+			FOnJoinSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnJoinSessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::Update:
+		Operation.CompletionHandle = SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(
+			FOnUpdateSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnUpdateSessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::Destroy:
+		Operation.CompletionHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
+			FOnDestroySessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnDestroySessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::Start:
+		Operation.CompletionHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(
+			FOnStartSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnStartSessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::End:
+		Operation.CompletionHandle = SessionInterface->AddOnEndSessionCompleteDelegate_Handle(
+			FOnEndSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnEndSessionComplete, Operation.Id));
+		break;
+	case ELobbyOperationType::FindById:
+		// The completion delegate is passed to FindSessionById itself
+		break;
+	case ELobbyOperationType::FindFriends:
+		Operation.CompletionHandle = SessionInterface->AddOnFindFriendSessionCompleteDelegate_Handle(
+			Operation.LocalUserNum,
+			FOnFindFriendSessionCompleteDelegate::CreateUObject(
+				this, &ThisClass::OnFindFriendSessionComplete, Operation.Id));
+		break;
+	}
+}
 
-	IOnlineSubsystem* OnlineSubsystem = Online::GetSubsystem(GetWorld());
-	IOnlineIdentityPtr IdentityInterface =
-		OnlineSubsystem ? OnlineSubsystem->GetIdentityInterface() : nullptr;
+void UMultiplayerSessionsSubsystem::ClearOperationDelegate(FLobbyOperation& Operation)
+{
+	if (!SessionInterface.IsValid() || !Operation.CompletionHandle.IsValid())
+	{
+		return;
+	}
 
-	if (IdentityInterface.IsValid())
+	switch (Operation.Type)
 	{
-		KickedPlayerInfo.PlayerName = IdentityInterface->GetPlayerNickname(*FoundPlayerId);
+	case ELobbyOperationType::Create:
+		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::Find:
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::Join:
+		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::Update:
+		SessionInterface->ClearOnUpdateSessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::Destroy:
+		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::Start:
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::End:
+		SessionInterface->ClearOnEndSessionCompleteDelegate_Handle(Operation.CompletionHandle);
+		break;
+	case ELobbyOperationType::FindById:
+		break;
+	case ELobbyOperationType::FindFriends:
+		SessionInterface->ClearOnFindFriendSessionCompleteDelegate_Handle(Operation.LocalUserNum,
+		                                                                  Operation.CompletionHandle);
+		break;
 	}
-	if (KickedPlayerInfo.PlayerName.IsEmpty())
+	Operation.CompletionHandle.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::AbortOperation(FLobbyOperation& Operation)
+{
+	UE_LOG(LogTemp, Warning, TEXT("Lobby operation %u %s"), Operation.Id,
+	       Operation.TimedOut() ? TEXT("timed out") : TEXT("cancelled"));
+
+	if (Operation.Type != ELobbyOperationType::Find || !SessionInterface.IsValid())
 	{
-		KickedPlayerInfo.PlayerName = TEXT("Unknown");
+		return;
 	}
 
-	// Store pending kick data
-	PendingKicks.Add(PlayerId, Reason);
-	PendingKickInfo.Add(PlayerId, KickedPlayerInfo);
+	// A deferred search never reached the backend, so there is nothing to take back
+	if (Operation.Id == AbandonedSearch.DeferredOperationId)
+	{
+		AbandonedSearch.DeferredOperationId = INVALID_LOBBY_OPERATION;
+		AbandonedSearch.DeferredStart = nullptr;
+		return;
+	}
 
-	// Unregister the player from the session
-	// This will trigger ONSessionParticipantRemoved on Steam
-	bool bSuccess = SessionInterface->UnregisterPlayer(NAME_GameSession, *FoundPlayerId);
-	if (!bSuccess)
+	// Searches are the only call the session interface can take back, but the backend may still
+	// answer the old search, so the next one waits for either answer
+	SessionInterface->CancelFindSessions();
+
+	AbandonedSearch.bIsPending = true;
+	AbandonedSearch.AbandonedTime = FPlatformTime::Seconds();
+	if (!AbandonedSearch.CompleteHandle.IsValid())
 	{
-		PendingKicks.Remove(PlayerId);
-		PendingKickInfo.Remove(PlayerId);
+		AbandonedSearch.CompleteHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(
+			FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::OnAbandonedSearchComplete));
+	}
+	if (!AbandonedSearch.CancelHandle.IsValid())
+	{
+		AbandonedSearch.CancelHandle = SessionInterface->AddOnCancelFindSessionsCompleteDelegate_Handle(
+			FOnCancelFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::OnAbandonedSearchComplete));
 	}
 }
 
-void UMultiplayerSessionsSubsystem::TransferHost(const FString& NewHostPlayerId)
+void UMultiplayerSessionsSubsystem::DeferSearchStart(FLobbyOperation& Operation)
 {
-	// TODO: Requires direct Steam API access
-	// Steam's SetLobbyOwner() not exposed through Unreal OSS
-	MultiplayerOnHostMigration.Broadcast(FLobbyPlayerInfo(), FLobbyPlayerInfo());
+	// Backends that never answer a cancelled search must not block searching for good,
+	// without a FindTimeout the answer is waited for however long it takes
+	if (FindTimeout > 0.f && FPlatformTime::Seconds() - AbandonedSearch.AbandonedTime > FindTimeout)
+	{
+		ResolveAbandonedSearch();
+		return;
+	}
+
+	// The scheduler still times the deferred search out, the wait counts against its own timeout
+	TFunction<bool(FLobbyOperation&)> Start = MoveTemp(Operation.Start);
+	Operation.Start = [this, Start = MoveTemp(Start)](FLobbyOperation& Op) mutable
+	{
+		UE_LOG(LogTemp, Log, TEXT("Search %u waits for an abandoned search to report back"), Op.Id);
+		AbandonedSearch.DeferredOperationId = Op.Id;
+		AbandonedSearch.DeferredStart = MoveTemp(Start);
+		return true;
+	};
+}
+
+void UMultiplayerSessionsSubsystem::OnAbandonedSearchComplete(bool bWasSuccessful)
+{
+	if (!AbandonedSearch.bIsPending)
+	{
+		return;
+	}
+
+	ResolveAbandonedSearch();
+	if (AbandonedSearch.DeferredOperationId == INVALID_LOBBY_OPERATION)
+	{
+		return;
+	}
+
+	// The deferred search's own delegate hears this same broadcast, so start it once the broadcast is over
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().SetTimerForNextTick(this, &ThisClass::StartDeferredSearch);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ResolveAbandonedSearch()
+{
+	AbandonedSearch.bIsPending = false;
+	if (SessionInterface.IsValid())
+	{
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(AbandonedSearch.CompleteHandle);
+		SessionInterface->ClearOnCancelFindSessionsCompleteDelegate_Handle(AbandonedSearch.CancelHandle);
+	}
+	AbandonedSearch.CompleteHandle.Reset();
+	AbandonedSearch.CancelHandle.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::StartDeferredSearch()
+{
+	const FLobbyOperationId OperationId = AbandonedSearch.DeferredOperationId;
+	TFunction<bool(FLobbyOperation&)> Start = MoveTemp(AbandonedSearch.DeferredStart);
+	AbandonedSearch.DeferredOperationId = INVALID_LOBBY_OPERATION;
+	AbandonedSearch.DeferredStart = nullptr;
+
+	// Cancelled or timed out while it waited
+	if (!Scheduler.IsRunningFor(OperationId, NAME_None))
+	{
+		return;
+	}
+
+	FLobbyOperation* Operation = Scheduler.FindOperation(OperationId);
+	if (!Start || !Start(*Operation))
+	{
+		Scheduler.Complete(OperationId, false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExpireOperations()
+{
+	Scheduler.ExpireOperations(FPlatformTime::Seconds());
+}
+
+FLobbyOperationId UMultiplayerSessionsSubsystem::ScheduleSessionCleanup(
+	FName SessionName, TFunction<void(const FLobbyOperation&)> OnComplete)
+{
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Destroy;
+	Operation.SessionName = SessionName;
+
+	// Cleanup runs even if whatever came before it failed
+	Operation.bRequireDependencySuccess = false;
+	Operation.Start = [this](FLobbyOperation& Op)
+	{
+		if (!SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		// Already gone (e.g. an earlier cleanup got there first)
+		if (!SessionInterface->GetNamedSession(Op.SessionName))
+		{
+			Scheduler.Complete(Op.Id, true);
+			return true;
+		}
+
+		return SessionInterface->DestroySession(Op.SessionName);
+	};
+	Operation.OnComplete = MoveTemp(OnComplete);
+
+	return Scheduler.Enqueue(MoveTemp(Operation));
+}
+
+/* LOBBY LIST SNAPSHOT */
+
+void UMultiplayerSessionsSubsystem::LoadLobbyListSnapshot()
+{
+	if (!bSaveLobbyListSnapshot)
+	{
+		return;
+	}
+
+	FLobbyListSnapshot Snapshot;
+	if (!Snapshot.LoadFromFile(FLobbyListSnapshot::GetDefaultPath()))
+	{
+		return;
+	}
+
+	const FTimespan Age = FDateTime::UtcNow() - Snapshot.Timestamp;
+	if (Age.GetTotalSeconds() > LobbyListSnapshotMaxAge)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Lobby list snapshot is %.0f hours old, ignoring it"), Age.GetTotalHours());
+		return;
+	}
+
+	// Base of the first diff, so the first search removes whatever has closed since
+	LastLobbyList = MoveTemp(Snapshot.Lobbies);
+	LastLobbyListTime = Snapshot.Timestamp;
+	bLobbyListIsStale = true;
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded %d lobbies from snapshot"), LastLobbyList.Num());
+}
+
+void UMultiplayerSessionsSubsystem::SaveLobbyListSnapshot() const
+{
+	// Nothing newer than what is on disk already
+	if (!bSaveLobbyListSnapshot || bLobbyListIsStale || LastLobbyListTime == FDateTime())
+	{
+		return;
+	}
+
+	FLobbyListSnapshot Snapshot;
+	Snapshot.Timestamp = LastLobbyListTime;
+	Snapshot.Lobbies = LastLobbyList;
+
+	if (!Snapshot.SaveToFile(FLobbyListSnapshot::GetDefaultPath()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not write lobby list snapshot"));
+	}
+}
+
+/* LOBBY HISTORY */
+
+const TArray<FLobbyHistoryEntry>& UMultiplayerSessionsSubsystem::GetLobbyHistory() const
+{
+	static const TArray<FLobbyHistoryEntry> EmptyHistory;
+	return LobbyHistory ? LobbyHistory->Entries : EmptyHistory;
+}
+
+void UMultiplayerSessionsSubsystem::SetLobbyFavorite(const FLobbyInfo& LobbyInfo, bool bIsFavorite)
+{
+	if (!LobbyHistory || !LobbyHistory->SetFavorite(LobbyInfo, bIsFavorite, MaxRecentLobbies))
+	{
+		return;
+	}
+
+	SaveLobbyHistory();
+	MultiplayerOnLobbyHistoryUpdated.Broadcast(LobbyHistory->Entries);
+}
+
+bool UMultiplayerSessionsSubsystem::IsLobbyFavorite(const FString& LobbyId) const
+{
+	return GetLobbyHistory().ContainsByPredicate([&LobbyId](const FLobbyHistoryEntry& Entry)
+	{
+		return Entry.bIsFavorite && Entry.LobbyInfo.LobbyId == LobbyId;
+	});
+}
+
+void UMultiplayerSessionsSubsystem::LoadLobbyHistory()
+{
+	if (UGameplayStatics::DoesSaveGameExist(LobbyHistorySlotName, 0))
+	{
+		LobbyHistory = Cast<ULobbyHistorySaveGame>(UGameplayStatics::LoadGameFromSlot(LobbyHistorySlotName, 0));
+	}
+
+	if (LobbyHistory && LobbyHistory->Version != ULobbyHistorySaveGame::CurrentVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Discarding lobby history of version %d"), LobbyHistory->Version);
+		LobbyHistory = nullptr;
+	}
+
+	if (!LobbyHistory)
+	{
+		LobbyHistory = Cast<ULobbyHistorySaveGame>(
+			UGameplayStatics::CreateSaveGameObject(ULobbyHistorySaveGame::StaticClass()));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded %d lobby history entries"), GetLobbyHistory().Num());
+}
+
+void UMultiplayerSessionsSubsystem::SaveLobbyHistory()
+{
+	if (LobbyHistory)
+	{
+		// A handful of entries, but no reason to block the game thread on the disk
+		UGameplayStatics::AsyncSaveGameToSlot(LobbyHistory, LobbyHistorySlotName, 0);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::RecordLobbyJoin(const FString& LobbyId)
+{
+	if (!LobbyHistory || LobbyId.IsEmpty())
+	{
+		return;
+	}
+
+	// Invite and link joins may not have gone through a search, keep at least the id
+	FLobbyInfo LobbyInfo;
+	LobbyInfo.LobbyId = LobbyId;
+	if (const FLobbySearchCacheEntry* CachedLobby = SearchCache.Find(LobbyId, FPlatformTime::Seconds()))
+	{
+		LobbyInfo = CachedLobby->LobbyInfo;
+	}
+
+	LobbyHistory->RecordJoin(LobbyInfo, MaxRecentLobbies);
+	SaveLobbyHistory();
+	MultiplayerOnLobbyHistoryUpdated.Broadcast(LobbyHistory->Entries);
+}
+
+void UMultiplayerSessionsSubsystem::ValidateLobbyHistory(const TArray<FLobbyInfo>& Lobbies)
+{
+	bool bInfoChanged = false;
+	if (!LobbyHistory || !LobbyHistory->ApplySearchResult(Lobbies, bInfoChanged))
+	{
+		return;
+	}
+
+	// Listing state is not saved, only new session ids and metadata are worth a write
+	if (bInfoChanged)
+	{
+		SaveLobbyHistory();
+	}
+	MultiplayerOnLobbyHistoryUpdated.Broadcast(LobbyHistory->Entries);
 }
 
 /* LOBBY CALLBACKS */
 /* Callbacks called by the registered delegates of Session Interface */
 
-void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful,
+                                                            FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful, FLobbyOperationId OperationId)
+{
+	// While an abandoned search is outstanding every search delegate hears its answer, including the
+	// one bound for the search deferred behind it
+	if (AbandonedSearch.bIsPending || OperationId == AbandonedSearch.DeferredOperationId)
+	{
+		return;
+	}
+
+	if (Scheduler.IsRunningFor(OperationId, NAME_None))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName,
+                                                          EOnJoinSessionCompleteResult::Type Result,
+                                                          FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, Result == EOnJoinSessionCompleteResult::Success, Result);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful,
+                                                             FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful,
+                                                           FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnEndSessionComplete(FName SessionName, bool bWasSuccessful,
+                                                         FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful,
+                                                            FLobbyOperationId OperationId)
+{
+	if (Scheduler.IsRunningFor(OperationId, SessionName))
+	{
+		Scheduler.Complete(OperationId, bWasSuccessful);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnFindSessionByIdComplete(int32 LocalUserNum, bool bWasSuccessful,
+                                                              const FOnlineSessionSearchResult& SearchResult,
+                                                              FLobbyOperationId OperationId,
+                                                              TSharedRef<FOnlineSessionSearchResult> OutResult)
+{
+	// The delegate cannot be unbound, a lookup that timed out may still answer
+	if (!Scheduler.IsRunningFor(OperationId, NAME_None))
+	{
+		return;
+	}
+
+	*OutResult = SearchResult;
+	Scheduler.Complete(OperationId, bWasSuccessful && SearchResult.IsValid());
+}
+
+void UMultiplayerSessionsSubsystem::OnReadFriendsListComplete(int32 LocalUserNum, bool bWasSuccessful,
+                                                              const FString& ListName, const FString& ErrorStr,
+                                                              FLobbyOperationId OperationId)
 {
-	if (SessionInterface)
+	// The read delegate cannot be unbound, a search that timed out may still answer
+	if (!Scheduler.IsRunningFor(OperationId, NAME_None))
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		return;
 	}
 
-	// Handle lobby creation vs session creation
-	if (bIsLobbyOperation)
+	if (!bWasSuccessful)
 	{
-		bIsLobbyOperation = false;
-		if (bWasSuccessful)
-		{
-			FLobbyInfo LobbyInfo = CreateLobbyInfoFromSession();
-			MultiplayerOnLobbyCreated.Broadcast(true, LobbyInfo);
-		}
-		else
-		{
-			MultiplayerOnLobbyCreated.Broadcast(false, FLobbyInfo());
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Could not read friends list: %s"), *ErrorStr);
+		Scheduler.Complete(OperationId, false);
+		return;
 	}
-	else
+
+	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
+	IOnlineFriendsPtr FriendsInterface = Subsystem ? Subsystem->GetFriendsInterface() : nullptr;
+	TArray<TSharedRef<FOnlineFriend>> Friends;
+	if (FriendsInterface.IsValid())
 	{
-		// Original behavior for CreateSession
-		MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessful);
+		FriendsInterface->GetFriendsList(LocalUserNum, ListName, Friends);
 	}
-}
 
-void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
-{
-	if (SessionInterface)
+	// Friends in another game cannot be in one of our lobbies
+	TArray<FUniqueNetIdRef> FriendIds;
+	for (const TSharedRef<FOnlineFriend>& Friend : Friends)
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		if (Friend->GetPresence().bIsPlayingThisGame)
+		{
+			FriendIds.Add(Friend->GetUserId());
+		}
 	}
 
-	if (!bWasSuccessful || !LastSessionSearch.IsValid() || LastSessionSearch->SearchResults.Num() <= 0)
+	if (FriendIds.Num() == 0)
 	{
-		MultiplayerOnLobbyListUpdated.Broadcast(TArray<FLobbyInfo>(), bWasSuccessful);
+		Scheduler.Complete(OperationId, true);
 		return;
 	}
 
-	// Convert to FLobbyInfo array
-	TArray<FLobbyInfo> FoundLobbies;
-
-	// Get local player ID to filter out own ghost lobbies
-	// IMPORTANT: We always get the local player ID, not just when we have an active session
-	// This filters out ghost lobbies from previous crashes even after restart
-	FUniqueNetIdRepl LocalPlayerId;
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (LocalPlayer)
+	const FUniqueNetIdRepl LocalPlayerId = LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId() : FUniqueNetIdRepl();
+	if (!LocalPlayerId.IsValid() || !SessionInterface.IsValid() ||
+		!SessionInterface->FindFriendSession(*LocalPlayerId, FriendIds))
 	{
-		LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
+		Scheduler.Complete(OperationId, false);
 	}
+}
 
-	for (const FOnlineSessionSearchResult& Result : LastSessionSearch->SearchResults)
+void UMultiplayerSessionsSubsystem::OnFindFriendSessionComplete(int32 LocalUserNum, bool bWasSuccessful,
+                                                                const TArray<FOnlineSessionSearchResult>& Results,
+                                                                FLobbyOperationId OperationId)
+{
+	if (!Scheduler.IsRunningFor(OperationId, NAME_None))
 	{
-		// Filter out any lobby owned by the local player (ghost session from crash)
-		if (LocalPlayerId.IsValid() && Result.Session.OwningUserId.IsValid())
-		{
-			if (*LocalPlayerId == *Result.Session.OwningUserId)
-			{
-				UE_LOG(LogTemp, Warning,
-				       TEXT("Filtering out own lobby (potential ghost session) from search results: %s"),
-				       *Result.GetSessionIdStr());
-				continue; // Skip this lobby
-			}
-		}
+		return;
+	}
 
-		// Additional validation: Skip lobbies with 0 open connections that are full
-		// (could indicate a stale lobby)
-		if (Result.Session.NumOpenPublicConnections <= 0 &&
-			Result.Session.SessionSettings.NumPublicConnections > 0)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Skipping full lobby: %s"), *Result.GetSessionIdStr());
-			// Don't skip - let user see full lobbies, but log it
-		}
+	FriendSearchResults = Results;
+	Scheduler.Complete(OperationId, bWasSuccessful);
+}
 
-		FoundLobbies.Add(ConvertSearchResultToLobbyInfo(Result));
+void UMultiplayerSessionsSubsystem::HandleLobbySearchComplete(bool bWasSuccessful, const FLobbySearchFilter& Filter)
+{
+	// A failed search keeps the cache as is
+	if (!bWasSuccessful || !LastSessionSearch.IsValid())
+	{
+		BroadcastLobbyList(TArray<FLobbyInfo>(), false);
+		HandleLobbyBrowseResult(false);
+		return;
 	}
-	MultiplayerOnLobbyListUpdated.Broadcast(FoundLobbies, true);
+
+	// Convert to FLobbyInfo array
+	TArray<FLobbyInfo> FoundLobbies;
+	CollectSearchResults(Filter, FoundLobbies);
+	MergeFriendLobbies(FoundLobbies);
+	ValidateLobbyHistory(FoundLobbies);
+	SetLastLobbyListFilter(Filter);
+
+	const bool bResultsChanged = BroadcastLobbyList(FoundLobbies, true);
+	HandleLobbyBrowseResult(bResultsChanged);
+}
+
+void UMultiplayerSessionsSubsystem::SetLastLobbyListFilter(const FLobbySearchFilter& Filter)
+{
+	// Fallbacks are joined without asking, so they still have to be public and have room
+	LastLobbyListPolicy = FQuickJoinPolicy();
+	LastLobbyListPolicy.Filter = Filter;
+	LastLobbyListPolicy.Filter.bOnlyNotFull = true;
+	LastLobbyListPolicy.Filter.bOnlyPublic = true;
 }
 
-void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+bool UMultiplayerSessionsSubsystem::BroadcastLobbyList(const TArray<FLobbyInfo>& Lobbies, bool bWasSuccessful)
 {
-	if (SessionInterface)
+	MultiplayerOnLobbyListUpdated.Broadcast(Lobbies, bWasSuccessful);
+
+	// A failed search says nothing about which lobbies are gone
+	if (!bWasSuccessful)
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		MultiplayerOnLobbyListChanged.Broadcast(FLobbyListDiff(), false);
+		return false;
 	}
 
-	if (bIsLobbyJoin)
+	TMap<FString, const FLobbyInfo*> PreviousLobbies;
+	PreviousLobbies.Reserve(LastLobbyList.Num());
+	for (const FLobbyInfo& Lobby : LastLobbyList)
 	{
-		bIsLobbyJoin = false;
+		PreviousLobbies.Add(Lobby.LobbyId, &Lobby);
+	}
 
-		ELobbyJoinResult LobbyJoinResult;
-		switch (Result)
+	FLobbyListDiff Diff;
+	for (const FLobbyInfo& Lobby : Lobbies)
+	{
+		const FLobbyInfo* const* Previous = PreviousLobbies.Find(Lobby.LobbyId);
+		if (!Previous)
 		{
-		case EOnJoinSessionCompleteResult::Success:
-			LobbyJoinResult = ELobbyJoinResult::Success;
-			break;
-		case EOnJoinSessionCompleteResult::SessionIsFull:
-			LobbyJoinResult = ELobbyJoinResult::LobbyFull;
-			break;
-		case EOnJoinSessionCompleteResult::SessionDoesNotExist:
-			LobbyJoinResult = ELobbyJoinResult::LobbyNotFound;
-			break;
-		case EOnJoinSessionCompleteResult::CouldNotRetrieveAddress:
-		case EOnJoinSessionCompleteResult::AlreadyInSession:
-		default:
-			LobbyJoinResult = ELobbyJoinResult::ConnectionFailed;
-			break;
+			Diff.Added.Add(Lobby);
+			continue;
 		}
 
-		// Cache connect address on success
-		if (Result == EOnJoinSessionCompleteResult::Success && SessionInterface)
-		{
-			FString Address;
-			SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
-			CachedConnectAddress = Address;
-
-			// Check if the address is empty or invalid (ghost lobby indicator)
-			if (Address.IsEmpty())
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Join succeeded but got empty connect address - possible ghost lobby"));
-				LobbyJoinResult = ELobbyJoinResult::ConnectionFailed;
-
-				// Clean up the invalid session
-				CleanupAfterFailedJoin();
-			}
-		}
-		else if (Result != EOnJoinSessionCompleteResult::Success)
+		if (Lobby.DiffersFrom(**Previous))
 		{
-			// On join failure, clear search results to force fresh search
-			if (LastSessionSearch.IsValid())
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Join failed, clearing cached search results"));
-				LastSessionSearch->SearchResults.Empty();
-			}
+			Diff.Changed.Add(Lobby);
 		}
-
-		MultiplayerOnLobbyJoinComplete.Broadcast(LobbyJoinResult);
+		PreviousLobbies.Remove(Lobby.LobbyId);
 	}
-	else
+
+	// Whatever was not matched is no longer listed
+	Diff.RemovedLobbyIds.Reserve(PreviousLobbies.Num());
+	for (const TPair<FString, const FLobbyInfo*>& Previous : PreviousLobbies)
 	{
-		if (Result == EOnJoinSessionCompleteResult::Success && SessionInterface)
-		{
-			FString Address;
-			SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
-			CachedConnectAddress = Address;
-		}
-		MultiplayerOnJoinSessionComplete.Broadcast(Result);
+		Diff.RemovedLobbyIds.Add(Previous.Key);
 	}
+
+	LastLobbyList = Lobbies;
+	LastLobbyListTime = FDateTime::UtcNow();
+	bLobbyListIsStale = false;
+	MultiplayerOnLobbyListChanged.Broadcast(Diff, true);
+	return !Diff.IsEmpty();
 }
 
-void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful)
+void UMultiplayerSessionsSubsystem::CollectSearchResults(const FLobbySearchFilter& Filter,
+                                                         TArray<FLobbyInfo>& OutLobbies)
 {
-	if (SessionInterface)
+	if (!LastSessionSearch.IsValid())
 	{
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+		return;
 	}
 
-	// Handle initialization cleanup
-	if (bIsInitializing)
+	const double Now = FPlatformTime::Seconds();
+
+	// Get local player ID to filter out own ghost lobbies
+	// IMPORTANT: We always get the local player ID, not just when we have an active session
+	// This filters out ghost lobbies from previous crashes even after restart
+	FUniqueNetIdRepl LocalPlayerId;
+	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	if (LocalPlayer)
 	{
-		bIsInitializing = false;
-		bInitializationComplete = true;
-		UE_LOG(LogTemp, Log, TEXT("Ghost session cleanup complete, subsystem ready."));
-		return;
+		LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
 	}
 
-	// Handle pending lobby creation
-	if (bHasPendingLobbyCreation && bWasSuccessful)
+	TArray<int32> SourceIndices;
+	FLobbySearchResultConverter::ConvertBatch(LastSessionSearch->SearchResults,
+	                                          LocalPlayerId.IsValid() ? LocalPlayerId.GetUniqueNetId().Get() : nullptr,
+	                                          Filter,
+	                                          &SearchCache,
+	                                          Now,
+	                                          SearchConversionParallelThreshold,
+	                                          OutLobbies,
+	                                          SourceIndices);
+
+	// The cache is not thread safe, fill it once the batch is converted
+	for (int32 Index = 0; Index < OutLobbies.Num(); ++Index)
 	{
-		bHasPendingLobbyCreation = false;
-		UE_LOG(LogTemp, Log, TEXT("Ghost session destroyed, creating new lobby..."));
-		CreateLobby(PendingLobbySettings);
-		return;
+		SearchCache.Add(LastSessionSearch->SearchResults[SourceIndices[Index]], OutLobbies[Index], Now);
 	}
 
-	// Handle pending search after stale session cleanup
-	if (bHasPendingSearch && bWasSuccessful)
+	// Lobbies matching the filter that a complete search did not return have closed,
+	// a search cut off at MaxSearchResults cannot tell
+	if (LastSessionSearch->SearchResults.Num() < LastSessionSearch->MaxSearchResults)
 	{
-		bHasPendingSearch = false;
-		UE_LOG(LogTemp, Log, TEXT("Stale session destroyed, proceeding with lobby search..."));
-		PerformFindLobbies(PendingSearchMaxResults);
-		return;
+		SearchCache.CompleteRefresh(Now, Filter);
 	}
-
-	// Original broadcast
-	if (MultiplayerOnDestroySessionComplete.IsBound())
+	else
 	{
-		MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessful);
+		SearchCache.MarkRefreshed(Now);
 	}
 }
 
-void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful)
+void UMultiplayerSessionsSubsystem::HandleLobbyJoinComplete(EOnJoinSessionCompleteResult::Type Result,
+                                                            const FString& LobbyId, bool bTimedOut)
 {
-	if (SessionInterface)
+	ELobbyJoinResult LobbyJoinResult;
+	switch (Result)
 	{
-		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+	case EOnJoinSessionCompleteResult::Success:
+		LobbyJoinResult = ELobbyJoinResult::Success;
+		break;
+	case EOnJoinSessionCompleteResult::SessionIsFull:
+		LobbyJoinResult = ELobbyJoinResult::LobbyFull;
+		break;
+	case EOnJoinSessionCompleteResult::SessionDoesNotExist:
+		LobbyJoinResult = ELobbyJoinResult::LobbyNotFound;
+		break;
+	case EOnJoinSessionCompleteResult::CouldNotRetrieveAddress:
+	case EOnJoinSessionCompleteResult::AlreadyInSession:
+	default:
+		LobbyJoinResult = ELobbyJoinResult::ConnectionFailed;
+		break;
 	}
 
-	MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
-}
-
-void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
-{
-	if (SessionInterface)
+	if (bTimedOut)
 	{
-		SessionInterface->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegateHandle);
+		LobbyJoinResult = ELobbyJoinResult::TimedOut;
+
+		// The abandoned join may still have created the local session
+		if (SessionInterface.IsValid() && SessionInterface->GetNamedSession(NAME_GameSession))
+		{
+			ScheduleSessionCleanup(NAME_GameSession);
+		}
 	}
 
-	if (bWasSuccessful)
+	// Cache connect address on success
+	if (Result == EOnJoinSessionCompleteResult::Success && SessionInterface)
 	{
-		FLobbyInfo UpdatedInfo = CreateLobbyInfoFromSession();
-		MultiplayerOnLobbySettingsUpdated.Broadcast(UpdatedInfo);
+		FString Address;
+		SessionInterface->GetResolvedConnectString(NAME_GameSession, Address);
+		CachedConnectAddress = Address;
+
+		// Check if the address is empty or invalid (ghost lobby indicator)
+		if (Address.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Join succeeded but got empty connect address - possible ghost lobby"));
+			LobbyJoinResult = ELobbyJoinResult::ConnectionFailed;
+
+			// Clean up the invalid session
+			CleanupAfterFailedJoin();
+		}
+		else
+		{
+			RecordLobbyJoin(LobbyId);
+		}
 	}
-	else
+	else if (Result != EOnJoinSessionCompleteResult::Success)
 	{
-		MultiplayerOnLobbySettingsUpdated.Broadcast(FLobbyInfo());
+		// On join failure, drop the lobby and force fresh search
+		UE_LOG(LogTemp, Warning, TEXT("Join failed, invalidating cached search results"));
+		SearchCache.Remove(LobbyId);
+		SearchCache.MarkStale();
+
+		// The list was out of date, browse at full speed again
+		if (LobbyBrowse.bIsActive)
+		{
+			LobbyBrowse.Interval = BrowseMinInterval;
+			ScheduleLobbyBrowseRefresh();
+		}
 	}
+
+	FinishLobbyJoin(LobbyJoinResult);
 }
 
 void UMultiplayerSessionsSubsystem::OnUnregisterPlayerComplete(FName SessionName,
                                                                const FUniqueNetId& PlayerId,
                                                                EOnSessionParticipantLeftReason Reason)
 {
+	// Party members leave through their own delegate, the game lobby is none of their business
+	const bool bIsParty = SessionName == NAME_PartySession;
+	if (SessionName != NAME_GameSession && !bIsParty)
+	{
+		return;
+	}
+
+	// Occupancy changed, let browsers know the lobby needs redrawing
+	if (!bIsParty && IsLobbyHost())
+	{
+		BumpLobbyDataVersion();
+	}
+
 	FString PlayerIdStr = PlayerId.ToString();
 
-	if (PendingKicks.Contains(PlayerIdStr))
+	if (!bIsParty && PendingKicks.Contains(PlayerIdStr))
 	{
 		// HOST PATH: Kick was initiated by this host
 		FString KickReason = PendingKicks[PlayerIdStr];
@@ -766,7 +2996,13 @@ void UMultiplayerSessionsSubsystem::OnUnregisterPlayerComplete(FName SessionName
 	if (LocalPlayer)
 	{
 		FUniqueNetIdRepl LocalPlayerId = LocalPlayer->GetPreferredUniqueNetId();
-		if (LocalPlayerId.IsValid() && *LocalPlayerId == PlayerId)
+		if (LocalPlayerId.IsValid() && *LocalPlayerId == PlayerId && bIsParty)
+		{
+			// Only the party session goes, the member left broadcast below covers the local player too
+			UE_LOG(LogTemp, Warning, TEXT("Local player removed from party, leaving it"));
+			ScheduleSessionCleanup(NAME_PartySession);
+		}
+		else if (LocalPlayerId.IsValid() && *LocalPlayerId == PlayerId)
 		{
 			// Local player is being removed - clean up local session state
 			UE_LOG(LogTemp, Warning, TEXT("Local player removed from session, cleaning up..."));
@@ -831,12 +3067,28 @@ void UMultiplayerSessionsSubsystem::OnUnregisterPlayerComplete(FName SessionName
 		break;
 	}
 
+	if (bIsParty)
+	{
+		MultiplayerOnPartyMemberLeft.Broadcast(LeftPlayerInfo, LeaveReason);
+		return;
+	}
 	MultiplayerOnPlayerLeftLobby.Broadcast(LeftPlayerInfo, LeaveReason);
 }
 
 void UMultiplayerSessionsSubsystem::OnRegisterPlayerComplete(FName SessionName,
                                                              const FUniqueNetId& PlayerId)
 {
+	const bool bIsParty = SessionName == NAME_PartySession;
+	if (SessionName != NAME_GameSession && !bIsParty)
+	{
+		return;
+	}
+
+	if (!bIsParty && IsLobbyHost())
+	{
+		BumpLobbyDataVersion();
+	}
+
 	// Build player info
 	FLobbyPlayerInfo JoinedPlayerInfo;
 	JoinedPlayerInfo.PlayerId = PlayerId.ToString();
@@ -856,10 +3108,104 @@ void UMultiplayerSessionsSubsystem::OnRegisterPlayerComplete(FName SessionName,
 		JoinedPlayerInfo.PlayerName = TEXT("Unknown");
 	}
 
+	if (bIsParty)
+	{
+		MultiplayerOnPartyMemberJoined.Broadcast(JoinedPlayerInfo);
+		return;
+	}
 	MultiplayerOnPlayerJoinedLobby.Broadcast(JoinedPlayerInfo);
 }
 
+void UMultiplayerSessionsSubsystem::OnSessionUserInviteAccepted(const bool bWasSuccessful, const int32 ControllerId,
+                                                                FUniqueNetIdPtr UserId,
+                                                                const FOnlineSessionSearchResult& InviteResult)
+{
+	if (!bWasSuccessful || !InviteResult.IsValid() || !SessionInterface.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Accepted invite could not be resolved"));
+		MultiplayerOnLobbyInviteAccepted.Broadcast(FLobbyInfo(), false);
+		return;
+	}
+
+	// Party invites leave the game lobby alone
+	bool bIsParty = false;
+	if (LobbyAttributes::FIsParty::Get(InviteResult.Session.SessionSettings, bIsParty) && bIsParty)
+	{
+		JoinParty(InviteResult);
+		return;
+	}
+
+	FLobbyInfo LobbyInfo;
+	FLobbySearchResultConverter::ConvertResult(InviteResult, LobbyInfo);
+	SearchCache.Add(InviteResult, LobbyInfo, FPlatformTime::Seconds());
+
+	// A join on the backend cannot be taken back, resetting the pipeline under it would leave its
+	// completion without an owner and its session behind
+	if (IsJoiningLobby())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Join already in progress, ignoring invite to %s"), *LobbyInfo.LobbyId);
+		MultiplayerOnLobbyInviteAccepted.Broadcast(LobbyInfo, false);
+		return;
+	}
+
+	MultiplayerOnLobbyInviteAccepted.Broadcast(LobbyInfo, true);
+
+	// The invite already carries the search result, join it as is.
+	// An invited player skips the password, and a friend's lobby has no fallbacks.
+	JoinPipeline = FJoinPipeline();
+	JoinPipeline.bIsActive = true;
+	JoinPipeline.bTravelOnJoin = true;
+	JoinPipeline.CurrentLobbyId = LobbyInfo.LobbyId;
+
+	// Accepting an invite leaves the current lobby, the join chains behind the destroy
+	if (SessionInterface->GetNamedSession(NAME_GameSession))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Leaving current lobby for accepted invite"));
+		ScheduleSessionCleanup(NAME_GameSession);
+	}
+
+	JoinSearchResult(InviteResult, LobbyInfo.LobbyId);
+}
+
+#if !UE_BUILD_SHIPPING
+void UMultiplayerSessionsSubsystem::SimulateInviteAccepted(const FString& LobbyId)
+{
+	ResolveLobbyById(LobbyId, [this](const FLobbyInfo* LobbyInfo)
+	{
+		const FLobbySearchCacheEntry* CachedLobby =
+			LobbyInfo ? SearchCache.Find(LobbyInfo->LobbyId, FPlatformTime::Seconds()) : nullptr;
+
+		OnSessionUserInviteAccepted(CachedLobby != nullptr, 0, nullptr,
+		                            CachedLobby ? CachedLobby->SearchResult : FOnlineSessionSearchResult());
+	});
+}
+
+namespace
+{
+	FAutoConsoleCommandWithWorldAndArgs SimulateInviteAcceptedCommand(
+		TEXT("MultiplayerSessions.SimulateInviteAccepted"),
+		TEXT("Join a lobby as if its invite was accepted in the platform overlay. Arg: lobby id"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+			UMultiplayerSessionsSubsystem* Subsystem =
+				GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+			if (Subsystem && Args.Num() > 0)
+			{
+				Subsystem->SimulateInviteAccepted(Args[0]);
+			}
+		}));
+}
+#endif
+
 /* LOBBY UTILITIES */
+void UMultiplayerSessionsSubsystem::BumpLobbyDataVersion()
+{
+	// Joins and leaves in quick succession share one update with any pending settings
+	PendingLobbyUpdate.bBumpDataVersion = true;
+	ScheduleLobbySettingsFlush();
+}
+
 FString UMultiplayerSessionsSubsystem::HashPassword(const FString& Password) const
 {
 	// Simple hash using MD5 - sufficient for lobby passwords
@@ -892,7 +3238,7 @@ void UMultiplayerSessionsSubsystem::PrintDebugMessage(const FString& Message, bo
 
 /* LOBBY MAPPERS */
 
-FLobbyInfo UMultiplayerSessionsSubsystem::CreateLobbyInfoFromSession() const
+FLobbyInfo UMultiplayerSessionsSubsystem::CreateLobbyInfoFromSession(FName SessionName) const
 {
 	FLobbyInfo Info;
 
@@ -901,7 +3247,7 @@ FLobbyInfo UMultiplayerSessionsSubsystem::CreateLobbyInfoFromSession() const
 		return Info;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SessionName);
 	if (!Session)
 	{
 		return Info;
@@ -912,8 +3258,7 @@ FLobbyInfo UMultiplayerSessionsSubsystem::CreateLobbyInfoFromSession() const
 	Info.CurrentPlayerCount = Info.MaxPlayerCount - Session->NumOpenPublicConnections;
 
 	// Retrieve stored metadata
-	Session->SessionSettings.Get(FName("HostName"), Info.HostName);
-	Session->SessionSettings.Get(FName("LobbyIsPublic"), Info.bIsPublic);
+	FLobbyMetadataCodec::Read(Session->SessionSettings, Info);
 
 	// Accepted Limitation for now,
 	// Cannot fetch ping in this scope,
@@ -923,49 +3268,44 @@ FLobbyInfo UMultiplayerSessionsSubsystem::CreateLobbyInfoFromSession() const
 	return Info;
 }
 
-FLobbyInfo UMultiplayerSessionsSubsystem::ConvertSearchResultToLobbyInfo(
-	const FOnlineSessionSearchResult& SearchResult) const
-{
-	FLobbyInfo LobbyInfo;
-
-	LobbyInfo.LobbyId = SearchResult.GetSessionIdStr();
-	LobbyInfo.MaxPlayerCount = SearchResult.Session.SessionSettings.NumPublicConnections;
-	LobbyInfo.CurrentPlayerCount = LobbyInfo.MaxPlayerCount - SearchResult.Session.NumOpenPublicConnections;
-	LobbyInfo.PingInMs = SearchResult.PingInMs;
-
-	SearchResult.Session.SessionSettings.Get(FName("HostName"), LobbyInfo.HostName);
-	SearchResult.Session.SessionSettings.Get(FName("LobbyIsPublic"), LobbyInfo.bIsPublic);
-
-	return LobbyInfo;
-}
-
 /* LOBBY QUERY METHODS */
 
-bool UMultiplayerSessionsSubsystem::IsInLobby() const
+bool UMultiplayerSessionsSubsystem::IsInLobby(FName SessionName) const
 {
 	if (!SessionInterface.IsValid())
 	{
 		return false;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SessionName);
 	return Session != nullptr;
 }
 
-FLobbyInfo UMultiplayerSessionsSubsystem::GetCurrentLobbyInfo() const
+FLobbyInfo UMultiplayerSessionsSubsystem::GetCurrentLobbyInfo(FName SessionName) const
 {
-	return CreateLobbyInfoFromSession();
+	return CreateLobbyInfoFromSession(SessionName);
 }
 
-bool UMultiplayerSessionsSubsystem::IsLobbyHost() const
+bool UMultiplayerSessionsSubsystem::IsLobbyHost(FName SessionName) const
 {
 	if (!SessionInterface.IsValid())
 	{
 		return false;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (!Session || !Session->OwningUserId)
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SessionName);
+	if (!Session)
+	{
+		return false;
+	}
+
+	// A dedicated server never joins, every session it has is its own
+	if (IsDedicatedServer())
+	{
+		return true;
+	}
+
+	if (!Session->OwningUserId)
 	{
 		return false;
 	}
@@ -980,7 +3320,7 @@ bool UMultiplayerSessionsSubsystem::IsLobbyHost() const
 	return LocalPlayerNetId.IsValid() && *LocalPlayerNetId == *Session->OwningUserId;
 }
 
-TArray<FLobbyPlayerInfo> UMultiplayerSessionsSubsystem::GetLobbyPlayers() const
+TArray<FLobbyPlayerInfo> UMultiplayerSessionsSubsystem::GetLobbyPlayers(FName SessionName) const
 {
 	TArray<FLobbyPlayerInfo> Players;
 	if (!SessionInterface.IsValid())
@@ -988,7 +3328,7 @@ TArray<FLobbyPlayerInfo> UMultiplayerSessionsSubsystem::GetLobbyPlayers() const
 		return Players;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SessionName);
 	if (!Session)
 	{
 		return Players;
@@ -1021,7 +3361,7 @@ TArray<FLobbyPlayerInfo> UMultiplayerSessionsSubsystem::GetLobbyPlayers() const
 	return Players;
 }
 
-FLobbyPlayerInfo UMultiplayerSessionsSubsystem::GetLobbyPlayer(const FUniqueNetId& PlayerId) const
+FLobbyPlayerInfo UMultiplayerSessionsSubsystem::GetLobbyPlayer(const FUniqueNetId& PlayerId, FName SessionName) const
 {
 	FLobbyPlayerInfo FoundPlayerInfo;
 	if (!SessionInterface.IsValid())
@@ -1029,7 +3369,7 @@ FLobbyPlayerInfo UMultiplayerSessionsSubsystem::GetLobbyPlayer(const FUniqueNetI
 		return FoundPlayerInfo;
 	}
 
-	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(NAME_GameSession);
+	FNamedOnlineSession* Session = SessionInterface->GetNamedSession(SessionName);
 	if (!Session)
 	{
 		return FoundPlayerInfo;
@@ -1064,10 +3404,17 @@ FLobbyPlayerInfo UMultiplayerSessionsSubsystem::GetLobbyPlayer(const FUniqueNetI
 	return FoundPlayerInfo;
 }
 
-void UMultiplayerSessionsSubsystem::LeaveLobby()
+void UMultiplayerSessionsSubsystem::LeaveLobby(FName SessionName)
 {
-	if (!IsInLobby())
+	if (!IsInLobby(SessionName))
+	{
+		return;
+	}
+
+	// Only the game lobby reports through MultiplayerOnDestroySessionComplete
+	if (SessionName != NAME_GameSession)
 	{
+		ScheduleSessionCleanup(SessionName);
 		return;
 	}
 
@@ -1098,6 +3445,7 @@ void UMultiplayerSessionsSubsystem::CleanupAfterFailedJoin()
 		LastSessionSearch->SearchResults.Empty();
 		LastSessionSearch.Reset();
 	}
+	SearchCache.Reset();
 
 	// Destroy any local session that may have been created during the failed join
 	if (SessionInterface.IsValid())
@@ -1108,17 +3456,9 @@ void UMultiplayerSessionsSubsystem::CleanupAfterFailedJoin()
 			UE_LOG(LogTemp, Warning, TEXT("Destroying orphaned session from failed join..."));
 
 			// Silently destroy the session (don't broadcast completion for cleanup)
-			DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
-				DestroySessionCompleteDelegate);
-
-			SessionInterface->DestroySession(NAME_GameSession);
+			ScheduleSessionCleanup(NAME_GameSession);
 		}
 	}
-
-	// Reset lobby state flags
-	bIsLobbyJoin = false;
-	bIsLobbyOperation = false;
-	bIsLobbySearch = false;
 }
 
 /* SESSION HANDLERS */
@@ -1131,45 +3471,47 @@ void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConntections, F
 		return;
 	}
 
+	// Recreate after the existing session is gone
 	auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
 	if (ExistingSession != nullptr)
 	{
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConntections;
-		LastMatchType = MatchType;
-		DestroySession();
-		return;
+		ScheduleSessionCleanup(NAME_GameSession);
 	}
 
-	// Store the delegate in a FDelegateHandle 
-	// so we can later remove it from the delegate list
-	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(
-		CreateSessionCompleteDelegate);
-
-	// Create Session Settings
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
-	LastSessionSettings->bIsLANMatch = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
-	LastSessionSettings->NumPublicConnections = NumPublicConntections;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
-	LastSessionSettings->Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->BuildUniqueId = 1;
-
-	// Create Session
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	bool isCreateSessionSuccessful = SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                                                 NAME_GameSession,
-	                                                                 *LastSessionSettings);
-
-	// If Create Session is not successful
-	// Remove Create Session Delegate from the delegate list
-	if (!isCreateSessionSuccessful)
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Create;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this, NumPublicConntections, MatchType](FLobbyOperation& Op)
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-	}
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
+
+		// Create Session Settings
+		LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
+		LastSessionSettings->bIsLANMatch = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
+		LastSessionSettings->NumPublicConnections = NumPublicConntections;
+		LastSessionSettings->bAllowJoinInProgress = true;
+		LastSessionSettings->bAllowJoinViaPresence = true;
+		LastSessionSettings->bShouldAdvertise = true;
+		LastSessionSettings->bUsesPresence = true;
+		LastSessionSettings->bUseLobbiesIfAvailable = true;
+		LobbyAttributes::FMatchType::Set(*LastSessionSettings, MatchType);
+		LastSessionSettings->BuildUniqueId = 1;
+
+		// Create Session
+		return SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(),
+		                                       Op.SessionName,
+		                                       *LastSessionSettings);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		MultiplayerOnCreateSessionComplete.Broadcast(Op.Succeeded());
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
 
 void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
@@ -1180,32 +3522,40 @@ void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
 		return;
 	}
 
-	// Add FindSessionsCompleteDelegate to the Session Interface Delegate List
-	// Then get the delegate handle pointer
-	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(
-		FindSessionsCompleteDelegate);
-
-	// Adjust the FindSessions Session Search Settings
-	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
-	LastSessionSearch->MaxSearchResults = MaxSearchResults;
-	LastSessionSearch->bIsLanQuery = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
-	LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
-
-	// Get LocalPlayer for UniqeNetId
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Find;
+	Operation.Start = [this, MaxSearchResults](FLobbyOperation& Op)
+	{
+		// Get LocalPlayer for UniqeNetId
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
 
-	// Trigger Find Sessions
-	bool bWasSuccessful = SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                                     LastSessionSearch.ToSharedRef());
+		// Adjust the FindSessions Session Search Settings
+		LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
+		LastSessionSearch->MaxSearchResults = MaxSearchResults;
+		LastSessionSearch->bIsLanQuery = Online::GetSubsystem(GetWorld())->GetSubsystemName() == "NULL";
+		LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
 
-	// Remove FindSessionsCompleteDelegateHandle from the Session Interface Delegate List
-	// If the Find Sessions fails
-	if (!bWasSuccessful)
+		// Trigger Find Sessions
+		return SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(),
+		                                      LastSessionSearch.ToSharedRef());
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		if (Op.Succeeded() && LastSessionSearch.IsValid())
+		{
+			MultiplayerOnFindSessionsComplete.Broadcast(LastSessionSearch->SearchResults, true);
+		}
+		else
+		{
+			MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		}
+	};
 
-		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
-	}
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
 
 void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& SessionResult)
@@ -1215,19 +3565,37 @@ void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult
 		return;
 	}
 
-	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(
-		JoinSessionCompleteDelegate);
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Join;
+	Operation.SessionName = NAME_GameSession;
+	Operation.ResultCode = EOnJoinSessionCompleteResult::UnknownError;
+	Operation.Start = [this, SessionResult](FLobbyOperation& Op)
+	{
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		if (!LocalPlayer || !SessionInterface.IsValid())
+		{
+			return false;
+		}
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	bool bWasSuccessful = SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(),
-	                                                    NAME_GameSession,
-	                                                    SessionResult);
-	if (!bWasSuccessful)
+		return SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(),
+		                                     Op.SessionName,
+		                                     SessionResult);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		const EOnJoinSessionCompleteResult::Type Result =
+			static_cast<EOnJoinSessionCompleteResult::Type>(Op.ResultCode);
 
-		MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
-	}
+		if (Result == EOnJoinSessionCompleteResult::Success && SessionInterface)
+		{
+			FString Address;
+			SessionInterface->GetResolvedConnectString(Op.SessionName, Address);
+			CachedConnectAddress = Address;
+		}
+		MultiplayerOnJoinSessionComplete.Broadcast(Result);
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
 
 void UMultiplayerSessionsSubsystem::DestroySession()
@@ -1238,15 +3606,20 @@ void UMultiplayerSessionsSubsystem::DestroySession()
 		return;
 	}
 
-	DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
-		DestroySessionCompleteDelegate);
-
-	bool bWasSuccessful = SessionInterface->DestroySession(NAME_GameSession);
-	if (!bWasSuccessful)
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Destroy;
+	Operation.SessionName = NAME_GameSession;
+	Operation.bRequireDependencySuccess = false;
+	Operation.Start = [this](FLobbyOperation& Op)
 	{
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
-	}
+		return SessionInterface.IsValid() && SessionInterface->DestroySession(Op.SessionName);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		MultiplayerOnDestroySessionComplete.Broadcast(Op.Succeeded());
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
 
 void UMultiplayerSessionsSubsystem::StartSession()
@@ -1256,12 +3629,17 @@ void UMultiplayerSessionsSubsystem::StartSession()
 		return;
 	}
 
-	StartSessionCompleteDelegateHandle = SessionInterface->
-		AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
-
-	const bool bWasSuccessful = SessionInterface->StartSession(NAME_GameSession);
-	if (!bWasSuccessful)
+	FLobbyOperation Operation;
+	Operation.Type = ELobbyOperationType::Start;
+	Operation.SessionName = NAME_GameSession;
+	Operation.Start = [this](FLobbyOperation& Op)
 	{
-		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
-	}
+		return SessionInterface.IsValid() && SessionInterface->StartSession(Op.SessionName);
+	};
+	Operation.OnComplete = [this](const FLobbyOperation& Op)
+	{
+		MultiplayerOnStartSessionComplete.Broadcast(Op.Succeeded());
+	};
+
+	Scheduler.Enqueue(MoveTemp(Operation));
 }
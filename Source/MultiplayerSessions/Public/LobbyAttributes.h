@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include <type_traits>
+
+/**
+ * A lobby session setting declared once with its key, value type and advertisement.
+ * Accessors only accept the declared type, and the key is interned on first use
+ * instead of building an FName at every call site.
+ */
+template <typename AttributeType, typename InValueType, EOnlineDataAdvertisementType::Type InAdvertisement>
+struct TLobbyAttribute
+{
+	using ValueType = InValueType;
+	static constexpr EOnlineDataAdvertisementType::Type Advertisement = InAdvertisement;
+
+	/** Interned key, safe to call from worker threads */
+	static const FName& Key()
+	{
+		static const FName InternedKey(AttributeType::Name);
+		return InternedKey;
+	}
+
+	template <typename ArgType>
+	static void Set(FOnlineSessionSettings& Settings, const ArgType& Value)
+	{
+		static_assert(std::is_same_v<ArgType, ValueType>, "Value type does not match the lobby attribute");
+		Settings.Set(Key(), Value, Advertisement);
+	}
+
+	/** Returns false and leaves OutValue untouched if the attribute is not set */
+	static bool Get(const FOnlineSessionSettings& Settings, ValueType& OutValue)
+	{
+		return Settings.Get(Key(), OutValue);
+	}
+
+	static void Remove(FOnlineSessionSettings& Settings)
+	{
+		Settings.Remove(Key());
+	}
+
+	/** Add a backend side search condition on this attribute */
+	template <typename ArgType>
+	static void Query(FOnlineSearchSettings& QuerySettings, const ArgType& Value,
+	                  EOnlineComparisonOp::Type Comparison)
+	{
+		static_assert(std::is_same_v<ArgType, ValueType>, "Value type does not match the lobby attribute");
+		QuerySettings.Set(Key(), Value, Comparison);
+	}
+};
+
+/** Schema of every setting a lobby advertises */
+namespace LobbyAttributes
+{
+	struct FIsPublic : TLobbyAttribute<FIsPublic, bool, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("LobbyIsPublic");
+	};
+
+	struct FHostName : TLobbyAttribute<FHostName, FString, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("HostName");
+	};
+
+	/** Only needed by joining clients, so not sent with ping responses */
+	struct FPasswordHash : TLobbyAttribute<FPasswordHash, FString, EOnlineDataAdvertisementType::ViaOnlineService>
+	{
+		static constexpr const TCHAR* Name = TEXT("PasswordHash");
+	};
+
+	/** Mirrors NumPublicConnections as a searchable key for capacity filters */
+	struct FMaxPlayers : TLobbyAttribute<FMaxPlayers, int32, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("LobbyMaxPlayers");
+	};
+
+	struct FGameMode : TLobbyAttribute<FGameMode, FString, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("GameMode");
+	};
+
+	struct FRegion : TLobbyAttribute<FRegion, FString, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("Region");
+	};
+
+	struct FBuildVersion : TLobbyAttribute<FBuildVersion, int32, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("BuildVersion");
+	};
+
+	/** Monotonic stamp, lets clients skip lobbies that did not change since the last search */
+	struct FDataVersion : TLobbyAttribute<FDataVersion, int32, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("DataVersion");
+	};
+
+	/** Marks a party session, which is joined through invites and never listed as a lobby */
+	struct FIsParty : TLobbyAttribute<FIsParty, bool, EOnlineDataAdvertisementType::ViaOnlineService>
+	{
+		static constexpr const TCHAR* Name = TEXT("LobbyIsParty");
+	};
+
+	/** Set while a match runs, searches drop these lobbies even if the backend still lists them */
+	struct FInProgress : TLobbyAttribute<FInProgress, bool, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("LobbyInProgress");
+	};
+
+	/** Browser-visible fields packed into one base64 blob, see FLobbyMetadataCodec */
+	struct FPackedMetadata : TLobbyAttribute<FPackedMetadata, FString, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("LobbyMeta");
+	};
+
+	/** Used by the legacy session flow */
+	struct FMatchType : TLobbyAttribute<FMatchType, FString, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing>
+	{
+		static constexpr const TCHAR* Name = TEXT("MatchType");
+	};
+}
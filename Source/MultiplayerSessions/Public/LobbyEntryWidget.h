@@ -36,6 +36,10 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Lobby")
 	FOnEntryClicked OnEntryClicked;
 
+	/** Delegate when the favorite button of this entry is clicked */
+	UPROPERTY(BlueprintAssignable, Category = "Lobby")
+	FOnEntryClicked OnFavoriteClicked;
+
 protected:
 	virtual void NativeConstruct() override;
 	virtual void NativeDestruct() override;
@@ -44,6 +48,9 @@ protected:
 	UFUNCTION()
 	void OnEntryButtonClicked();
 
+	UFUNCTION()
+	void OnFavoriteButtonClicked();
+
 	UFUNCTION()
 	void OnEntryHovered();
 
@@ -54,6 +61,9 @@ private:
 	/** Update display with current lobby info */
 	void UpdateDisplay();
 
+	/** Update only the fields measured per search (player count, ping) */
+	void UpdateLiveDisplay();
+
 	// Bound UI Components
 	UPROPERTY(meta = (BindWidget))
 	UButton* EntryButton;
@@ -70,6 +80,14 @@ private:
 	UPROPERTY(meta = (BindWidget))
 	UImage* LockIcon;
 
+	/** Marks lobbies of friends */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UImage* FriendIcon;
+
+	/** Toggles the lobby as favorite, kept across restarts */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton* FavoriteButton;
+
 	UPROPERTY(meta = (BindWidget))
 	UBorder* BackgroundBorder;
 
@@ -5,10 +5,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "MultiplayerSessionsTypes.h"
 #include "LobbyGameMode.generated.h"
 
 class ALobbyGameState;
 class ALobbyPlayerState;
+class UMultiplayerSessionsSubsystem;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnAllPlayersReady);
 
@@ -35,6 +37,7 @@ public:
 	/**
 	 * Start the game and travel to the game level.
 	 * Only works if called on server and all players are ready.
+	 * Moves the hosted lobby to Starting, so it stops being advertised and joinable.
 	 * @param GameLevelPath - The path to the game level (e.g., "/Game/Maps/GameLevel?listen")
 	 * @return True if game start was initiated
 	 */
@@ -53,6 +56,14 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Lobby")
 	FOnNotAllPlayersReady OnNotAllPlayersReady;
 
+	/** On a dedicated server, create and advertise a lobby on BeginPlay if there is none yet */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	bool bHostLobbyOnDedicatedServer = true;
+
+	/** Lobby a dedicated server hosts */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	FLobbySettings DedicatedServerLobbySettings;
+
 protected:
 	/** Called when any player's ready state changes */
 	UFUNCTION()
@@ -64,5 +75,7 @@ private:
 	/** Track if all players were previously ready */
 	bool bWasAllReady = false;
 
+	UMultiplayerSessionsSubsystem* GetMultiplayerSessionsSubsystem() const;
+
 	void CheckReadyState();
 };
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "MultiplayerSessionsTypes.h"
+#include "LobbyHistorySaveGame.generated.h"
+
+/** A lobby the local player joined or marked as favorite */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FLobbyHistoryEntry
+{
+	GENERATED_BODY()
+
+	/** Last known state, the session id is what a re-join resolves */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	FLobbyInfo LobbyInfo;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	FDateTime LastJoinedTime;
+
+	/** Favorites are never trimmed */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	bool bIsFavorite;
+
+	/** Returned by a search since startup, not saved */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Lobby")
+	bool bIsListed;
+
+	FLobbyHistoryEntry() :
+		bIsFavorite(false),
+		bIsListed(false)
+	{
+	}
+};
+
+/**
+ * Recently joined and favorite lobbies, kept across restarts.
+ * Most recent first, at most MaxRecent entries besides favorites.
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API ULobbyHistorySaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	/** Bumped when the saved layout changes, older saves are discarded */
+	static constexpr int32 CurrentVersion = 1;
+
+	UPROPERTY()
+	int32 Version = CurrentVersion;
+
+	UPROPERTY()
+	TArray<FLobbyHistoryEntry> Entries;
+
+	/** Move the lobby to the front, trimming the oldest non-favorites beyond MaxRecent */
+	void RecordJoin(const FLobbyInfo& LobbyInfo, int32 MaxRecent);
+
+	/** Returns false if nothing changed */
+	bool SetFavorite(const FLobbyInfo& LobbyInfo, bool bIsFavorite, int32 MaxRecent);
+
+	FLobbyHistoryEntry* FindEntry(const FString& LobbyId);
+
+	/**
+	 * Refresh entries from a search result. Hosts that re-hosted under a new session id are
+	 * matched by their net id, never by the display name any player can share.
+	 * Sets bOutInfoChanged if anything worth saving changed.
+	 * Returns true if any entry changed at all.
+	 */
+	bool ApplySearchResult(const TArray<FLobbyInfo>& Lobbies, bool& bOutInfoChanged);
+
+private:
+	void Trim(int32 MaxRecent);
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionsTypes.h"
+
+/**
+ * Last successful lobby list, written to disk on shutdown so the browser
+ * has something to show on the next cold start while the first search runs.
+ *
+ * Compact binary layout: magic, format version, UTC timestamp, lobby count,
+ * then the fields of each lobby. A file of another format version is ignored.
+ */
+struct MULTIPLAYERSESSIONS_API FLobbyListSnapshot
+{
+	/** Bumped whenever the layout changes */
+	static constexpr uint32 FormatVersion = 1;
+
+	FDateTime Timestamp;
+	TArray<FLobbyInfo> Lobbies;
+
+	/** Default location under Saved/ */
+	static FString GetDefaultPath();
+
+	bool SaveToFile(const FString& Path) const;
+
+	/** Returns false for a missing, foreign or malformed file, leaving this snapshot untouched */
+	bool LoadFromFile(const FString& Path);
+};
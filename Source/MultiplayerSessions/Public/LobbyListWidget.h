@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
 #include "MultiplayerSessionsTypes.h"
+#include "LobbyHistorySaveGame.h"
 #include "LobbyListWidget.generated.h"
 
 class UMultiplayerSessionsSubsystem;
@@ -35,6 +36,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Lobby")
 	void RefreshLobbyList();
 
+	/** Keep the list refreshing in the background while shown (needs bEnableBackgroundBrowse on the subsystem) */
+	UFUNCTION(BlueprintCallable, Category = "Lobby")
+	void SetBrowsingActive(bool bActive);
+
 	/** Delegate when user selects a lobby to join */
 	UPROPERTY(BlueprintAssignable, Category = "Lobby")
 	FOnLobbySelected OnLobbySelected;
@@ -54,17 +59,47 @@ protected:
 	UFUNCTION()
 	void OnBackButtonClicked();
 
-	/** Callback from subsystem */
+	/** Callback from subsystem, applies the change since the previous search */
+	UFUNCTION()
+	void OnLobbyListChanged(const FLobbyListDiff& Diff, bool bWasSuccessful);
+
+	/** Callback from subsystem in paged mode */
 	UFUNCTION()
-	void OnLobbyListUpdated(const TArray<FLobbyInfo>& Lobbies, bool bWasSuccessful);
+	void OnLobbyPageReceived(const TArray<FLobbyInfo>& Lobbies, bool bHasMorePages, bool bWasSuccessful);
+
+	/** Requests the next page when scrolled near the end */
+	UFUNCTION()
+	void OnLobbyListScrolled(float CurrentOffset);
 
 	UFUNCTION()
 	void OnLobbyEntryClicked(const FLobbyInfo& LobbyInfo);
 
+	UFUNCTION()
+	void OnLobbyEntryFavoriteClicked(const FLobbyInfo& LobbyInfo);
+
+	/** Callback from subsystem, rebuilds the recent lobbies */
+	UFUNCTION()
+	void OnLobbyHistoryUpdated(const TArray<FLobbyHistoryEntry>& History);
+
 private:
-	/** Populate the scroll box with lobby entries */
+	/** Match the scroll box to a full lobby list, reusing existing entries */
 	void PopulateLobbyList(const TArray<FLobbyInfo>& Lobbies);
 
+	/** Insert, remove and update entries in place */
+	void ApplyLobbyListDiff(const FLobbyListDiff& Diff);
+
+	/** Move the existing rows into the order of Lobbies if they drifted from it, e.g. after a re-ranking */
+	void MatchLobbyListOrder(const TArray<FLobbyInfo>& Lobbies);
+
+	void RemoveLobbyEntryAt(int32 Index);
+
+	/** Add a single lobby entry at Index, appended for INDEX_NONE */
+	void AddLobbyEntry(const FLobbyInfo& Lobby, int32 Index = INDEX_NONE);
+
+	/** Show recent and favorite lobbies, dimmed while no search has listed them */
+	void PopulateRecentLobbies(const TArray<FLobbyHistoryEntry>& History);
+	void ClearRecentLobbies();
+
 	/** Clear all lobby entries */
 	void ClearLobbyList();
 
@@ -74,6 +109,9 @@ private:
 	/** Update status text */
 	void UpdateStatusText(int32 LobbyCount);
 
+	/** Keep lobbies of the subsystem's warm start snapshot visible and say how old they are */
+	void ShowStaleLobbyList();
+
 	// Bound UI Components
 	UPROPERTY(meta = (BindWidget))
 	UScrollBox* LobbyScrollBox;
@@ -93,6 +131,10 @@ private:
 	UPROPERTY(meta = (BindWidget))
 	UTextBlock* StatusText;
 
+	/** Recently joined and favorite lobbies, shown before any search has finished */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UScrollBox* RecentLobbyScrollBox;
+
 	// Configuration
 	// NOT IMPLEMENTED YET
 	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
@@ -101,6 +143,36 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
 	int32 MaxSearchResults = 100;
 
+	/** Applied by the backend where possible, so unjoinable lobbies don't use up MaxSearchResults */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	FLobbySearchFilter SearchFilter;
+
+	/** Load lobbies in pages as the list is scrolled instead of one full search */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	bool bUsePagedSearch = false;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby", meta = (EditCondition = "bUsePagedSearch"))
+	int32 LobbyPageSize = 20;
+
+	/** Distance from the end of the list (in slate units) that triggers the next page */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby", meta = (EditCondition = "bUsePagedSearch"))
+	float NextPageScrollThreshold = 100.f;
+
+	/** Refresh with the narrower queries of SearchPlan instead of one search with SearchFilter */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby", meta = (EditCondition = "!bUsePagedSearch"))
+	bool bUseSearchPlan = false;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby", meta = (EditCondition = "bUseSearchPlan"))
+	FLobbySearchPlan SearchPlan;
+
+	/** Also look up friends' lobbies on refresh, they are listed first */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby", meta = (EditCondition = "!bUsePagedSearch"))
+	bool bIncludeFriendLobbies = true;
+
+	/** Opacity of recent lobbies the last search did not list */
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	float UnlistedRecentLobbyOpacity = 0.5f;
+
 	// State
 	UPROPERTY()
 	UMultiplayerSessionsSubsystem* SessionsSubsystem;
@@ -108,4 +180,11 @@ private:
 	// NOT IMPLEMENTED YET
 	UPROPERTY()
 	TArray<ULobbyEntryWidget*> LobbyEntryWidgets;
+
+	UPROPERTY()
+	TArray<ULobbyEntryWidget*> RecentLobbyEntryWidgets;
+
+	// Paged search state
+	bool bIsLoadingPage = false;
+	bool bHasMorePages = false;
 };
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionsTypes.h"
+
+class FOnlineSessionSettings;
+
+/**
+ * Reads and writes the browser-visible lobby metadata of a session.
+ *
+ * In packed mode the descriptive fields (host name, game mode, region,
+ * build version, flags) travel as one versioned binary blob in a single
+ * setting instead of one key per field. Fields the backend filters on
+ * (LobbyIsPublic, LobbyMaxPlayers) and the DataVersion stamp stay separate
+ * keys in both modes.
+ * Occupancy always comes from the session's own connection counts.
+ */
+class MULTIPLAYERSESSIONS_API FLobbyMetadataCodec
+{
+public:
+	/** Current blob layout. Newer layouts only append fields, so older readers still decode them. */
+	static constexpr uint8 PackedVersion = 1;
+
+	/** Write the metadata fields of Info, packed or one key per field */
+	static void Write(FOnlineSessionSettings& Settings, const FLobbyInfo& Info, bool bPacked);
+
+	/** Fill the metadata fields of OutInfo from either layout */
+	static void Read(const FOnlineSessionSettings& Settings, FLobbyInfo& OutInfo);
+
+	/** Stamp a change to settings or membership, the first stamp is 1 */
+	static void BumpDataVersion(FOnlineSessionSettings& Settings);
+
+	/** Base64 blob holding the metadata fields of Info */
+	static FString Encode(const FLobbyInfo& Info);
+
+	/** Returns false for a malformed blob, leaving OutInfo untouched */
+	static bool Decode(const FString& Packed, FLobbyInfo& OutInfo);
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+typedef uint32 FLobbyOperationId;
+
+/** Sentinel for "no operation" */
+static constexpr FLobbyOperationId INVALID_LOBBY_OPERATION = 0;
+
+/** Kind of backend call an operation wraps */
+enum class ELobbyOperationType : uint8
+{
+	Create, Find, Join, Update, Destroy, Start, End,
+
+	/** Single session lookup, completes through the delegate passed to the call */
+	FindById,
+
+	/** Sessions of the local user's friends, completes through a per-user delegate */
+	FindFriends
+};
+
+enum class ELobbyOperationState : uint8
+{
+	Pending, Running, Succeeded, Failed,
+
+	/** Abandoned by the scheduler, the backend never answered in time */
+	TimedOut,
+
+	/** Abandoned on request */
+	Cancelled
+};
+
+/**
+ * A single asynchronous session call tracked by the scheduler.
+ * Each operation owns its completion delegate handle, so overlapping
+ * operations of the same type never clobber each other.
+ */
+struct MULTIPLAYERSESSIONS_API FLobbyOperation
+{
+	FLobbyOperationId Id{INVALID_LOBBY_OPERATION};
+	ELobbyOperationType Type{ELobbyOperationType::Create};
+	ELobbyOperationState State{ELobbyOperationState::Pending};
+
+	/** Session the operation mutates, NAME_None for session-less calls (Find) */
+	FName SessionName{NAME_None};
+
+	/** Operations that must finish before this one may start */
+	TArray<FLobbyOperationId> Dependencies;
+
+	/** If true, a failed dependency fails this operation without starting it */
+	bool bRequireDependencySuccess{true};
+
+	/** Local user the completion delegate is registered for, where the interface keys delegates by user */
+	int32 LocalUserNum{0};
+
+	/** Backend specific result recorded by the completion callback (e.g. EOnJoinSessionCompleteResult) */
+	int32 ResultCode{0};
+
+	/** Completion delegate handle registered on the session interface */
+	FDelegateHandle CompletionHandle;
+
+	/** Time by which a running operation times out, 0 if it never does */
+	double Deadline{0.0};
+
+	/** Issues the backend call. Returns false if the call could not be started. */
+	TFunction<bool(FLobbyOperation&)> Start;
+
+	/** Called once when the operation finishes, after its delegate handle has been cleared */
+	TFunction<void(const FLobbyOperation&)> OnComplete;
+
+	bool Succeeded() const { return State == ELobbyOperationState::Succeeded; }
+	bool TimedOut() const { return State == ELobbyOperationState::TimedOut; }
+	bool WasCancelled() const { return State == ELobbyOperationState::Cancelled; }
+};
+
+/**
+ * Runs session operations as a dependency graph.
+ *
+ * Operations mutating the same named session are chained implicitly in
+ * submission order, as are searches (the session interface only allows one
+ * search in flight). Everything else runs concurrently.
+ *
+ * Running operations of a type with a timeout are abandoned once it passes,
+ * so a backend that never calls back cannot stall everything chained behind.
+ */
+class MULTIPLAYERSESSIONS_API FLobbyOperationScheduler
+{
+public:
+	/** Called before an operation starts, to register its completion delegate */
+	TFunction<void(FLobbyOperation&)> BindHandler;
+
+	/** Called when an operation finishes, to clear its completion delegate */
+	TFunction<void(FLobbyOperation&)> UnbindHandler;
+
+	/** Called when a running operation times out or is cancelled, before its delegate is cleared */
+	TFunction<void(FLobbyOperation&)> AbortHandler;
+
+	/** Seconds operations of this type may run, 0 (the default) for no limit */
+	void SetTimeout(ELobbyOperationType Type, double Seconds) { Timeouts.Add(Type, Seconds); }
+
+	/** Queue an operation. Starts immediately if nothing it depends on is outstanding. */
+	FLobbyOperationId Enqueue(FLobbyOperation&& Operation);
+
+	/** Finish a running operation and start any operations that were waiting on it */
+	void Complete(FLobbyOperationId OperationId, bool bWasSuccessful, int32 ResultCode = 0);
+
+	/** Finish every outstanding operation as failed, without starting anything new */
+	void Reset();
+
+	/** Finish running operations past their deadline as TimedOut */
+	void ExpireOperations(double Now);
+
+	/** Finish every outstanding operation of this type as Cancelled */
+	void Cancel(ELobbyOperationType Type);
+
+	/** Returns the outstanding operation, nullptr once it has finished */
+	FLobbyOperation* FindOperation(FLobbyOperationId OperationId) const;
+
+	/** True if a completion callback for this session belongs to the given operation */
+	bool IsRunningFor(FLobbyOperationId OperationId, FName SessionName) const;
+
+	/** True if any outstanding (pending or running) operation of this type exists */
+	bool HasOutstanding(ELobbyOperationType Type, FName SessionName = NAME_None) const;
+
+private:
+	/** Start every pending operation whose dependencies are resolved */
+	void Pump();
+
+	/** Whether B must wait for A when both are outstanding */
+	static bool Conflicts(const FLobbyOperation& A, const FLobbyOperation& B);
+
+	void Finish(const TSharedRef<FLobbyOperation>& Operation, ELobbyOperationState FinalState);
+
+	/** Outstanding operations, in submission order */
+	TArray<TSharedRef<FLobbyOperation>> Operations;
+
+	/** Final state of finished operations still referenced as dependencies */
+	TMap<FLobbyOperationId, bool> FinishedResults;
+
+	TMap<ELobbyOperationType, double> Timeouts;
+
+	FLobbyOperationId NextOperationId{1};
+	bool bIsPumping{false};
+	bool bPumpRequested{false};
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include "MultiplayerSessionsTypes.h"
+
+/** A lobby as last seen by a search */
+struct MULTIPLAYERSESSIONS_API FLobbySearchCacheEntry
+{
+	FOnlineSessionSearchResult SearchResult;
+	FLobbyInfo LobbyInfo;
+	double LastSeenTime{0.0};
+};
+
+/**
+ * Search results keyed by session id.
+ * Entries expire TimeToLive seconds after the last search that returned them.
+ */
+class MULTIPLAYERSESSIONS_API FLobbySearchCache
+{
+public:
+	void SetTimeToLive(double InTimeToLive) { TimeToLive = InTimeToLive; }
+
+	/** Insert or refresh a lobby seen at Now */
+	void Add(const FOnlineSessionSearchResult& SearchResult, const FLobbyInfo& LobbyInfo, double Now);
+
+	/** O(1) lookup, nullptr if unknown or expired */
+	const FLobbySearchCacheEntry* Find(const FString& LobbyId, double Now) const;
+
+	void Remove(const FString& LobbyId);
+
+	/** Drop lobbies within the search filter that the search completed at Now did not return */
+	void CompleteRefresh(double Now, const FLobbySearchFilter& Scope);
+
+	/** Drop expired entries */
+	void Prune(double Now);
+
+	/** Mark the cache refreshed by a truncated search, which cannot tell closed lobbies apart */
+	void MarkRefreshed(double Now) { LastRefreshTime = Now; }
+
+	/** Force the next search to go to the backend, keeping entries servable */
+	void MarkStale() { LastRefreshTime = 0.0; }
+
+	void Reset();
+
+	/** All unexpired lobbies */
+	void GetLobbies(TArray<FLobbyInfo>& OutLobbies, double Now) const;
+
+	bool IsEmpty() const { return Entries.Num() == 0; }
+	bool HasRefreshed() const { return LastRefreshTime > 0.0; }
+
+	/** Seconds since the last completed search */
+	double GetAge(double Now) const { return HasRefreshed() ? Now - LastRefreshTime : TNumericLimits<double>::Max(); }
+
+private:
+	bool IsExpired(const FLobbySearchCacheEntry& Entry, double Now) const
+	{
+		return Now - Entry.LastSeenTime > TimeToLive;
+	}
+
+	TMap<FString, FLobbySearchCacheEntry> Entries;
+	double TimeToLive{60.0};
+	double LastRefreshTime{0.0};
+};
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionsTypes.h"
+
+class FOnlineSessionSearchResult;
+class FUniqueNetId;
+class FLobbySearchCache;
+
+/**
+ * Turns raw search results into FLobbyInfo in one batch.
+ * Community searches can return thousands of results at once, so the
+ * conversion writes into a pre-sized output, reads settings through the
+ * interned LobbyAttributes keys and fans out across worker threads for
+ * large batches.
+ */
+class MULTIPLAYERSESSIONS_API FLobbySearchResultConverter
+{
+public:
+	/**
+	 * Convert a single result into OutInfo.
+	 * If Previous carries the same DataVersion its metadata is reused instead of decoded again.
+	 */
+	static void ConvertResult(const FOnlineSessionSearchResult& SearchResult, FLobbyInfo& OutInfo,
+	                          const FLobbyInfo* Previous = nullptr);
+
+	/** Same, with the session id already built by the caller, moved into OutInfo instead of built again */
+	static void ConvertResult(const FOnlineSessionSearchResult& SearchResult, FString&& SessionId,
+	                          FLobbyInfo& OutInfo, const FLobbyInfo* Previous = nullptr);
+
+	/**
+	 * Convert every result, dropping lobbies owned by LocalPlayerId (ghost sessions),
+	 * lobbies with a match in progress, parties and lobbies not matching Filter. Order of the results is preserved.
+	 *
+	 * @param PreviousLobbies		Lobbies from earlier searches, only read, nullptr to always convert
+	 * @param ParallelThreshold		Batches at least this large are converted with ParallelFor
+	 * @param OutLobbies			Converted lobbies
+	 * @param OutSourceIndices		Index into SearchResults for each entry of OutLobbies
+	 */
+	static void ConvertBatch(const TArray<FOnlineSessionSearchResult>& SearchResults,
+	                         const FUniqueNetId* LocalPlayerId,
+	                         const FLobbySearchFilter& Filter,
+	                         const FLobbySearchCache* PreviousLobbies,
+	                         double Now,
+	                         int32 ParallelThreshold,
+	                         TArray<FLobbyInfo>& OutLobbies,
+	                         TArray<int32>& OutSourceIndices);
+};
@@ -69,6 +69,13 @@ private:
 	UPROPERTY(meta = (BindWidget))
 	UButton* JoinButton;
 
+	// Joins the best ranked lobby without opening the browser
+	UPROPERTY(meta = (BindWidgetOptional))
+	UButton* QuickPlayButton;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	FQuickJoinPolicy QuickJoinPolicy;
+
 	// New widget references
 	UPROPERTY(meta = (BindWidget))
 	UCreateLobbyWidget* CreateLobbyWidget;
@@ -97,6 +104,9 @@ private:
 	UFUNCTION()
 	void JoinButtonClicked();
 
+	UFUNCTION()
+	void QuickPlayButtonClicked();
+
 	// Widget callback handlers
 	UFUNCTION()
 	void OnLobbyCreationComplete(bool bSuccess);
@@ -119,6 +129,13 @@ private:
 	UFUNCTION()
 	void OnLobbyJoinComplete(ELobbyJoinResult Result);
 
+	/** Result of a join started from a lobby link, opens the menu if it failed */
+	UFUNCTION()
+	void OnLinkJoinComplete(ELobbyJoinResult Result);
+
+	UFUNCTION()
+	void OnLobbyInviteAccepted(const FLobbyInfo& LobbyInfo, bool bWasSuccessful);
+
 	// Travel Method
 	void TravelToLobby();
 
@@ -140,4 +157,7 @@ private:
 	int32 NumPublicConnections{4};
 	FString MatchType{TEXT("FreeForAll")};
 	FString PathToLobby{TEXT("")};
+
+	/** LobbyPath as passed to MenuSetup, to set the menu up again after a failed link join */
+	FString LobbyMapPath{TEXT("")};
 };
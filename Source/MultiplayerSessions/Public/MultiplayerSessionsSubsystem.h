@@ -4,10 +4,18 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/EngineBaseTypes.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "MultiplayerSessionsTypes.h"
+#include "LobbyOperationScheduler.h"
+#include "LobbySearchCache.h"
+#include "LobbyHistorySaveGame.h"
 #include "MultiplayerSessionsSubsystem.generated.h"
 
+class UNetDriver;
+class ULocalPlayer;
+
 // Declaring our own custom delegates for the Menu class to bind callbacks to
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnCreateSessionComplete, bool, bWasSuccessful);
 
@@ -37,10 +45,30 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnLobbyListUpdated,
                                              const TArray<FLobbyInfo>&, Lobbies,
                                              bool, bWasSuccessful);
 
+// Lobby search result as a diff against the previous result
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnLobbyListChanged,
+                                             const FLobbyListDiff&, Diff,
+                                             bool, bWasSuccessful);
+
+// Lobby search batch in paged mode, more may follow via RequestNextLobbyPage
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FMultiplayerOnLobbyPageReceived,
+                                               const TArray<FLobbyInfo>&, Lobbies,
+                                               bool, bHasMorePages,
+                                               bool, bWasSuccessful);
+
 // Lobby join attempt result
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnLobbyJoinComplete,
                                             ELobbyJoinResult, Result);
 
+// Platform invite or join via presence accepted, the join result follows through FMultiplayerOnLobbyJoinComplete
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnLobbyInviteAccepted,
+                                             const FLobbyInfo&, LobbyInfo,
+                                             bool, bWasSuccessful);
+
+// Recent and favorite lobbies changed, e.g. validated by a search
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnLobbyHistoryUpdated,
+                                            const TArray<FLobbyHistoryEntry>&, History);
+
 // Lobby player joined event
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnPlayerJoinedLobby,
                                             const FLobbyPlayerInfo&, PlayerInfo);
@@ -63,6 +91,10 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnHostMigration,
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnLobbySettingsUpdated,
                                             const FLobbyInfo&, UpdatedLobbyInfo);
 
+// Hosted lobby moved to another lifecycle state
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnLobbyLifecycleChanged,
+                                            ELobbyLifecycleState, NewState);
+
 
 // DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnUnregisterPlayerComplete,
 //                                              const FUniqueNetId&, PlayerId,
@@ -71,7 +103,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnLobbySettingsUpdated,
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class MULTIPLAYERSESSIONS_API UMultiplayerSessionsSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
@@ -81,14 +113,248 @@ public:
 
 	// LOBBY HANDLERS
 	// -----------------------
-	void CreateLobby(const FLobbySettings& Settings);
-	void FindLobbies(int32 MaxResult = 100);
-	void JoinLobby(const FLobbyInfo& LobbyInfo, const FString& Password = TEXT(""));
+	// Lobby calls take the session they act on, NAME_GameSession unless stated otherwise.
+	// Search, join and lifecycle calls only ever touch NAME_GameSession, so a party survives them.
+
+	/**
+	 * Create a lobby under SessionName, replacing any session of that name.
+	 * On a dedicated server the lobby is created and advertised under the server's own identity.
+	 */
+	void CreateLobby(const FLobbySettings& Settings, FName SessionName = NAME_GameSession);
+
+	/** Headless server, lobbies are hosted without a local player and it is host of every session it has */
+	bool IsDedicatedServer() const;
+
+	/**
+	 * Create a hidden, non-advertised session ahead of CreateLobby, e.g. when the create view opens.
+	 * CreateLobby then publishes it with one UpdateSession instead of a full create round trip.
+	 * Only if bPrepareHostedLobby is set and there is no session yet.
+	 */
+	void PrepareLobby();
+
+	/** Destroy the prepared session if the host backs out. Searches and joins drop it on their own. */
+	void CancelPreparedLobby();
+
+	void FindLobbies(int32 MaxResult = 100, const FLobbySearchFilter& Filter = FLobbySearchFilter());
+
+	/**
+	 * Run the queries of Plan one after another and broadcast their deduplicated union, ranked by
+	 * Plan.Ranking, through the lobby list delegates. Stops early once Plan.EnoughCandidates
+	 * eligible lobbies were found. Only one planned search runs at a time, a new one replaces it.
+	 */
+	void FindLobbiesWithPlan(const FLobbySearchPlan& Plan);
+
+	/** Narrows from the preferred region and game mode on the local build down to any lobby with room */
+	static FLobbySearchPlan MakePreferredSearchPlan(const FString& Region, const FString& GameMode);
+
+	/**
+	 * Look up the sessions of friends playing this game in one query. They are flagged bIsFriendLobby,
+	 * merged into the lobby list ahead of the search results and kept there by later FindLobbies calls.
+	 * Friend lobbies are listed whatever the search filter, the join still checks capacity and password.
+	 */
+	void FindFriendLobbies();
+
+	/** bTravelOnJoin travels as soon as the join succeeds, for flows without a menu to do it */
+	void JoinLobby(const FLobbyInfo& LobbyInfo, const FString& Password = TEXT(""), bool bTravelOnJoin = false);
+
+	/** Join a lobby known only by its id, resolving just that session instead of searching */
+	void JoinLobbyById(const FString& LobbyId, const FString& Password = TEXT(""), bool bTravelOnJoin = false);
+
+	/**
+	 * Join and travel to the lobby named by a link, without going through the menu.
+	 * Accepts command line (-lobby=<id> -lobbypassword=<password>) and URL query
+	 * (?lobby=<id>&lobbypassword=<password>) forms. The command line is checked on startup.
+	 * Returns false if the link names no lobby.
+	 */
+	bool JoinLobbyFromLink(const FString& Link);
+
+	/** A link join is waiting for the first map or still joining, the menu should stay closed until its join result */
+	bool IsJoiningFromLink() const;
+
+#if !UE_BUILD_SHIPPING
+	/** Resolve a lobby and handle it like an accepted platform invite, for backends without an overlay (NULL) */
+	void SimulateInviteAccepted(const FString& LobbyId);
+#endif
+
+	/**
+	 * Search, rank the results by Policy and join the best lobby, falling back to the next best
+	 * on failure. Only the final outcome is broadcast through MultiplayerOnLobbyJoinComplete.
+	 */
+	void QuickJoin(const FQuickJoinPolicy& Policy = FQuickJoinPolicy());
+
+	/** A join or one of its fallbacks is still in progress */
+	bool IsJoiningLobby() const { return JoinPipeline.bIsActive && !JoinPipeline.bJoined; }
+
+	/**
+	 * Client travel to the lobby joined last. If the connect address is missing or the travel
+	 * fails, the session is cleaned up and the next best lobby of the same search is joined.
+	 */
+	bool TravelToJoinedLobby();
+
+	/**
+	 * Paged lobby search. Batches arrive through MultiplayerOnLobbyPageReceived as soon as
+	 * they are available (cached lobbies first), deduplicated by LobbyId across the session.
+	 */
+	void FindLobbiesPaged(int32 PageSize = 20, const FLobbySearchFilter& Filter = FLobbySearchFilter());
+
+	/** Ask for another page of the current paged search */
+	void RequestNextLobbyPage();
+
+	/**
+	 * Background browsing, only if bEnableBackgroundBrowse is set. Refreshes the lobby list on a
+	 * timer that backs off while results stay the same and resets after changes or join failures.
+	 */
+	void StartLobbyBrowsing(int32 MaxResult = 100, const FLobbySearchFilter& Filter = FLobbySearchFilter());
+	void StopLobbyBrowsing();
+	bool IsBrowsingLobbies() const { return LobbyBrowse.bIsActive; }
+
+	/** One search ahead of opening the browser so it opens on current results, same opt-in as browsing */
+	void WarmUpLobbySearch(int32 MaxResult = 100, const FLobbySearchFilter& Filter = FLobbySearchFilter());
+
+	bool HasMoreLobbyPages() const;
+
+	/** Abandon every search still queued or in flight, e.g. when the browser closes. Nothing is broadcast for them. */
+	void CancelFindLobbies();
+
+	/**
+	 * Host only. Calls within LobbySettingsUpdateWindow are merged into one update, which only
+	 * writes the fields that differ from the session and skips the backend if none do.
+	 */
 	void UpdateLobbySettings(const FLobbySettings& NewSettings);
 	void SetLobbyVisibility(bool bIsPublic, const FString& Password = TEXT(""));
 	void KickPlayer(const FString& PlayerId, const FString& Reason = TEXT(""));
 	void TransferHost(const FString& NewHostPlayerId);
 
+	// PARTY
+	// -----------------------
+	// A persistent, non-advertised session under NAME_PartySession, next to the game lobby.
+	// Members join through platform invites, and the party outlives lobbies and match travel.
+
+	/** Create a party led by the local player, replacing any party the player is in */
+	void CreateParty(int32 MaxMembers = 4);
+
+	/** Leave the party, disbanding it if the local player leads it */
+	void LeaveParty();
+
+	bool IsInParty() const { return IsInLobby(NAME_PartySession); }
+	bool IsPartyLeader() const { return IsLobbyHost(NAME_PartySession); }
+	TArray<FLobbyPlayerInfo> GetPartyMembers() const { return GetLobbyPlayers(NAME_PartySession); }
+
+	// MATCH LIFECYCLE
+	// -----------------------
+	// Host only. Lobby -> Starting -> InGame -> PostGame -> Lobby, driven by ALobbyGameMode.
+
+	/**
+	 * Lobby -> Starting. Stops advertising, closes join in progress and starts the session,
+	 * InGame once the backend answers. Returns false if not hosting a lobby in the Lobby state.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Lobby")
+	bool BeginMatch();
+
+	/** Starting or InGame -> PostGame. Ends the session, the lobby stays closed */
+	UFUNCTION(BlueprintCallable, Category = "Lobby")
+	void EndMatch();
+
+	/** Back to Lobby from any other state, ending the session if the match never ended, and advertise again */
+	UFUNCTION(BlueprintCallable, Category = "Lobby")
+	void ReturnToLobby();
+
+	UFUNCTION(BlueprintPure, Category = "Lobby")
+	ELobbyLifecycleState GetLobbyLifecycleState() const { return LobbyLifecycleState; }
+
+	// CONFIGURATION
+	// -----------------------
+	// Set in DefaultGame.ini under [/Script/MultiplayerSessions.MultiplayerSessionsSubsystem]
+
+	/** Seconds a lobby stays in the search cache (servable and joinable) after a search last returned it */
+	UPROPERTY(Config)
+	float SearchCacheTimeToLive = 60.f;
+
+	/** A cache refreshed more recently than this answers FindLobbies without a backend search */
+	UPROPERTY(Config)
+	float SearchCacheFreshPeriod = 5.f;
+
+	/** Searches returning at least this many results are converted on worker threads */
+	UPROPERTY(Config)
+	int32 SearchConversionParallelThreshold = 256;
+
+	/** Advertise host name, game mode, region and build version as one packed setting */
+	UPROPERTY(Config)
+	bool bPackLobbyMetadata = false;
+
+	/** Allow StartLobbyBrowsing / WarmUpLobbySearch to search in the background */
+	UPROPERTY(Config)
+	bool bEnableBackgroundBrowse = false;
+
+	/** Lobbies of the same search a JoinLobby falls back on when the join or travel fails, 0 disables */
+	UPROPERTY(Config)
+	int32 MaxJoinFallbacks = 2;
+
+	/** Background refresh interval in seconds right after the list changed */
+	UPROPERTY(Config)
+	float BrowseMinInterval = 10.f;
+
+	/** Background refresh interval cap while the list stays the same */
+	UPROPERTY(Config)
+	float BrowseMaxInterval = 60.f;
+
+	/** Interval growth per refresh without changes */
+	UPROPERTY(Config)
+	float BrowseBackoffMultiplier = 2.f;
+
+	/** Seconds each operation type may wait for the backend before it fails as timed out, 0 for no limit */
+	UPROPERTY(Config)
+	float CreateTimeout = 30.f;
+
+	UPROPERTY(Config)
+	float FindTimeout = 30.f;
+
+	UPROPERTY(Config)
+	float JoinTimeout = 30.f;
+
+	UPROPERTY(Config)
+	float UpdateTimeout = 15.f;
+
+	UPROPERTY(Config)
+	float DestroyTimeout = 15.f;
+
+	UPROPERTY(Config)
+	float StartTimeout = 15.f;
+
+	UPROPERTY(Config)
+	float EndTimeout = 15.f;
+
+	/** Seconds UpdateLobbySettings waits for further changes before updating the session, 0 updates at once */
+	UPROPERTY(Config)
+	float LobbySettingsUpdateWindow = 0.25f;
+
+	/** Host name dedicated server lobbies advertise, the machine name if empty */
+	UPROPERTY(Config)
+	FString DedicatedServerName;
+
+	/** Search for lobbies hosted on dedicated servers instead of player hosted ones */
+	UPROPERTY(Config)
+	bool bFindDedicatedServerLobbies = false;
+
+	/** Allow PrepareLobby to create the hidden standby session */
+	UPROPERTY(Config)
+	bool bPrepareHostedLobby = true;
+
+	/** Recently joined lobbies remembered across restarts, favorites come on top */
+	UPROPERTY(Config)
+	int32 MaxRecentLobbies = 10;
+
+	UPROPERTY(Config)
+	FString LobbyHistorySlotName = TEXT("LobbyHistory");
+
+	/** Write the last lobby list to disk on shutdown and show it on the next start until a search replaces it */
+	UPROPERTY(Config)
+	bool bSaveLobbyListSnapshot = true;
+
+	/** Snapshots older than this many seconds are not shown */
+	UPROPERTY(Config)
+	float LobbyListSnapshotMaxAge = 86400.f;
+
 	// CUSTOM DELEGATES
 	// -----------------------
 	// Our own custom delegates, for the Menu class to bind callbacks to
@@ -102,25 +368,60 @@ public:
 	// ----------------------
 	FMultiplayerOnLobbyCreated MultiplayerOnLobbyCreated;
 	FMultiplayerOnLobbyListUpdated MultiplayerOnLobbyListUpdated;
+	FMultiplayerOnLobbyListChanged MultiplayerOnLobbyListChanged;
+	FMultiplayerOnLobbyPageReceived MultiplayerOnLobbyPageReceived;
 	FMultiplayerOnLobbyJoinComplete MultiplayerOnLobbyJoinComplete;
+	FMultiplayerOnLobbyInviteAccepted MultiplayerOnLobbyInviteAccepted;
+	FMultiplayerOnLobbyHistoryUpdated MultiplayerOnLobbyHistoryUpdated;
 	FMultiplayerOnPlayerJoinedLobby MultiplayerOnPlayerJoinedLobby;
 	FMultiplayerOnPlayerLeftLobby MultiplayerOnPlayerLeftLobby;
 	FMultiplayerOnKickedFromLobby MultiplayerOnKickedFromLobby;
 	FMultiplayerOnHostMigration MultiplayerOnHostMigration;
 	FMultiplayerOnLobbySettingsUpdated MultiplayerOnLobbySettingsUpdated;
+	FMultiplayerOnLobbyLifecycleChanged MultiplayerOnLobbyLifecycleChanged;
+
+	// PARTY DELEGATES
+	// ----------------------
+	FMultiplayerOnLobbyCreated MultiplayerOnPartyCreated;
+	FMultiplayerOnLobbyJoinComplete MultiplayerOnPartyJoinComplete;
+	FMultiplayerOnPlayerJoinedLobby MultiplayerOnPartyMemberJoined;
+
+	/** Also fires for the local player, whose party session is then dropped */
+	FMultiplayerOnPlayerLeftLobby MultiplayerOnPartyMemberLeft;
 
 	// LOBBY QUERY METHODS
 	// ------------------------
-	FLobbyInfo GetCurrentLobbyInfo() const;
-	TArray<FLobbyPlayerInfo> GetLobbyPlayers() const;
-	FLobbyPlayerInfo GetLobbyPlayer(const FUniqueNetId& PlayerId) const;
-	bool IsLobbyHost() const;
-	bool IsInLobby() const;
-	void LeaveLobby();
+	FLobbyInfo GetCurrentLobbyInfo(FName SessionName = NAME_GameSession) const;
+	TArray<FLobbyPlayerInfo> GetLobbyPlayers(FName SessionName = NAME_GameSession) const;
+	FLobbyPlayerInfo GetLobbyPlayer(const FUniqueNetId& PlayerId, FName SessionName = NAME_GameSession) const;
+	bool IsLobbyHost(FName SessionName = NAME_GameSession) const;
+	bool IsInLobby(FName SessionName = NAME_GameSession) const;
+	void LeaveLobby(FName SessionName = NAME_GameSession);
+
+	/** Lobby list as of the last MultiplayerOnLobbyListChanged, the base of the next diff */
+	const TArray<FLobbyInfo>& GetLastLobbyList() const { return LastLobbyList; }
+
+	/** The last lobby list was loaded from the shutdown snapshot, no search has confirmed it yet */
+	bool IsLobbyListStale() const { return bLobbyListIsStale; }
+
+	/** UTC time of the last lobby list, default if there is none */
+	const FDateTime& GetLobbyListTimestamp() const { return LastLobbyListTime; }
+
+	/**
+	 * Recently joined and favorite lobbies, most recent first. Loaded on startup with their last
+	 * known info and validated by every lobby search. Re-join them with JoinLobbyById.
+	 */
+	const TArray<FLobbyHistoryEntry>& GetLobbyHistory() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Lobby")
+	void SetLobbyFavorite(const FLobbyInfo& LobbyInfo, bool bIsFavorite);
+
+	bool IsLobbyFavorite(const FString& LobbyId) const;
 
 	/**
 	 * Call this after a failed ClientTravel to clean up the local session state.
 	 * This prevents "ghost session" issues where a join succeeded but travel failed.
+	 * Travels started through TravelToJoinedLobby do this on their own.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Lobby")
 	void CleanupAfterFailedJoin();
@@ -150,16 +451,30 @@ protected:
 	// ------------------------
 	// Internal callbacks for the delegates
 	// These will be called within this class
-	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
-	void OnFindSessionsComplete(bool bWasSuccessful);
-	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
-	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
-	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
-	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
+	// Each operation binds its own delegate, the id routes the callback back to it
+	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnFindSessionsComplete(bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result,
+	                           FLobbyOperationId OperationId);
+	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnEndSessionComplete(FName SessionName, bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful, FLobbyOperationId OperationId);
+	void OnFindFriendSessionComplete(int32 LocalUserNum, bool bWasSuccessful,
+	                                 const TArray<FOnlineSessionSearchResult>& Results,
+	                                 FLobbyOperationId OperationId);
+	void OnReadFriendsListComplete(int32 LocalUserNum, bool bWasSuccessful, const FString& ListName,
+	                               const FString& ErrorStr, FLobbyOperationId OperationId);
+	void OnFindSessionByIdComplete(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult,
+	                               FLobbyOperationId OperationId, TSharedRef<FOnlineSessionSearchResult> OutResult);
 	void OnUnregisterPlayerComplete(FName SessionName, const FUniqueNetId& PlayerId,
 	                                EOnSessionParticipantLeftReason Reason);
 	void OnRegisterPlayerComplete(FName SessionName, const FUniqueNetId& PlayerId);
 
+	/** Invites accepted in the platform overlay, on Steam also joins through a friend's presence */
+	void OnSessionUserInviteAccepted(const bool bWasSuccessful, const int32 ControllerId, FUniqueNetIdPtr UserId,
+	                                 const FOnlineSessionSearchResult& InviteResult);
+
 private:
 	typedef UMultiplayerSessionsSubsystem ThisClass;
 
@@ -169,52 +484,279 @@ private:
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
 	FString CachedConnectAddress;
 
+	// Lobbies from recent searches, keyed by session id
+	FLobbySearchCache SearchCache;
+
+	/** Last FindLobbies search queued, repeats of it are answered by its broadcast */
+	struct FLobbySearchRequest
+	{
+		FLobbyOperationId OperationId{INVALID_LOBBY_OPERATION};
+		int32 MaxResult{0};
+		FLobbySearchFilter Filter;
+	};
+	FLobbySearchRequest LobbySearchRequest;
+
+	/** Last broadcast lobby list, diffed against by BroadcastLobbyList */
+	TArray<FLobbyInfo> LastLobbyList;
+	FDateTime LastLobbyListTime;
+	bool bLobbyListIsStale{false};
+
+	/** Filter and ranking of the search behind LastLobbyList, join fallbacks are drawn from that list with it */
+	FQuickJoinPolicy LastLobbyListPolicy;
+	void SetLastLobbyListFilter(const FLobbySearchFilter& Filter);
+
+	/** Warm start, LastLobbyList from the previous run */
+	void LoadLobbyListSnapshot();
+	void SaveLobbyListSnapshot() const;
+
+	/** Recent and favorite lobbies, saved to LobbyHistorySlotName on every change */
+	UPROPERTY()
+	ULobbyHistorySaveGame* LobbyHistory;
+
+	void LoadLobbyHistory();
+	void SaveLobbyHistory();
+
+	/** Remember a lobby joined just now */
+	void RecordLobbyJoin(const FString& LobbyId);
+
+	/** Mark history entries listed or not and refresh their info from a search result */
+	void ValidateLobbyHistory(const TArray<FLobbyInfo>& Lobbies);
+
+	/** Lobbies of the last friend search, dropped once they leave the search cache */
+	TArray<FLobbyInfo> FriendLobbies;
+
+	/** Raw results of the friend search in flight, friend searches never overlap */
+	TArray<FOnlineSessionSearchResult> FriendSearchResults;
+
+	/** Flag and add friend lobbies to a lobby list and move them to the front, search order is kept otherwise */
+	void MergeFriendLobbies(TArray<FLobbyInfo>& Lobbies);
+
+	// Paged search state
+	struct FLobbyPagedSearch
+	{
+		bool bIsActive{false};
+		uint32 Generation{0};
+		int32 PageSize{20};
+		FLobbySearchFilter Filter;
+
+		/** Lobbies the consumer asked for but has not received yet */
+		int32 Demand{0};
+
+		/** MaxSearchResults of the last backend search */
+		int32 RequestedResults{0};
+
+		bool bHasSearched{false};
+		bool bIsSearching{false};
+		bool bBackendExhausted{false};
+
+		/** Stale session cleanup the first backend search waits for */
+		FLobbyOperationId CleanupId{INVALID_LOBBY_OPERATION};
+
+		TSet<FString> DeliveredLobbyIds;
+		TArray<FLobbyInfo> QueuedLobbies;
+	};
+	FLobbyPagedSearch PagedSearch;
+
+	// Planned search state
+	struct FLobbyPlannedSearch
+	{
+		bool bIsActive{false};
+		uint32 Generation{0};
+		FLobbySearchPlan Plan;
+		int32 NextQuery{0};
+		int32 FailedQueries{0};
+
+		/** Merged results in discovery order, deduplicated by LobbyId */
+		TArray<FLobbyInfo> Lobbies;
+		TSet<FString> LobbyIds;
+		int32 EligibleCount{0};
+	};
+	FLobbyPlannedSearch PlannedSearch;
+
+	/** Queue the next query of the plan, false if there is none left */
+	bool RunNextPlannedQuery();
+
+	/** Rank the merged results and broadcast them */
+	void FinishPlannedSearch();
+
+	// Background browse state
+	struct FLobbyBrowse
+	{
+		bool bIsActive{false};
+		int32 MaxResults{100};
+		FLobbySearchFilter Filter;
+		float Interval{0.f};
+		FTimerHandle RefreshTimer;
+	};
+	FLobbyBrowse LobbyBrowse;
+
+	void RefreshLobbyBrowse();
+	void ScheduleLobbyBrowseRefresh();
+
+	/** Adapt the refresh interval to a backend search result */
+	void HandleLobbyBrowseResult(bool bResultsChanged);
+
+	// Join pipeline state, shared by JoinLobby and QuickJoin
+	struct FJoinCandidate
+	{
+		FLobbyInfo LobbyInfo;
+		FOnlineSessionSearchResult SearchResult;
+		float Score{0.f};
+	};
+
+	struct FJoinPipeline
+	{
+		bool bIsActive{false};
+		FQuickJoinPolicy Policy;
+
+		/** Best first, already capped at Policy.MaxJoinAttempts */
+		TArray<FJoinCandidate> Candidates;
+		int32 NextCandidate{0};
+
+		/** Lobby of the join in flight or last joined */
+		FString CurrentLobbyId;
+
+		/** Session joined, waiting for the client travel */
+		bool bJoined{false};
+		bool bTravelPending{false};
+
+		/** Fallback joins travel on their own, the menu that started the first travel is gone */
+		bool bTravelOnJoin{false};
+	};
+	FJoinPipeline JoinPipeline;
+
+	/** Rank cached lobbies against JoinPipeline.Policy */
+	void RankJoinCandidates(const TArray<FLobbyInfo>& Lobbies);
+
+	/** Join the next ranked candidate, false if there is none left */
+	bool TryNextJoinCandidate();
+
+	/** Drop the lobby we failed to reach and move on to the next candidate */
+	void HandleJoinTravelFailure(const FString& Reason);
+	void RetryJoinAfterTravelFailure();
+
+	// Engine travel events, only acted upon while a join travel is pending
+	void OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString);
+	void OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, ENetworkFailure::Type FailureType,
+	                      const FString& ErrorString);
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	// Link join waiting for a local player
+	struct FPendingLinkJoin
+	{
+		FString LobbyId;
+		FString Password;
+	};
+	FPendingLinkJoin PendingLinkJoin;
+
+	/** Set from the start of a link join until its join result, so the menu stays closed while the id resolves */
+	bool bIsJoiningFromLink{false};
+
+	/** Ends the link join, if any, before telling listeners */
+	void BroadcastLobbyJoinComplete(ELobbyJoinResult Result);
+
+	/** Start the pending link join once there is a local player to join with */
+	void StartPendingLinkJoin();
+
+	FDelegateHandle TravelFailureHandle;
+	FDelegateHandle NetworkFailureHandle;
+	FDelegateHandle PostLoadMapHandle;
+
 	// DELEGATES
 	// ------------------------
-	// To add ONLINE SESSION INTERFACE DELEGATE LIST
-	// Internal Multiplayer Sessions Subsystem callbacks will be bound to these delegates
-	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate;
-	FDelegateHandle CreateSessionCompleteDelegateHandle;
-	FOnFindSessionsCompleteDelegate FindSessionsCompleteDelegate;
-	FDelegateHandle FindSessionsCompleteDelegateHandle;
-	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
-	FDelegateHandle JoinSessionCompleteDelegateHandle;
-	FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
-	FDelegateHandle DestroySessionCompleteDelegateHandle;
-	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
-	FDelegateHandle StartSessionCompleteDelegateHandle;
-	FOnUpdateSessionCompleteDelegate UpdateSessionCompleteDelegate;
-	FDelegateHandle UpdateSessionCompleteDelegateHandle;
+	// Persistent session interface delegates
+	// Per-operation completion delegates are owned by the scheduler
 	FOnSessionParticipantLeftDelegate SessionParticipantLeftDelegate;
 	FDelegateHandle SessionParticipantLeftDelegateHandle;
 	FOnSessionParticipantJoinedDelegate SessionParticipantJoinedDelegate;
 	FDelegateHandle SessionParticipantJoinedDelegateHandle;
+	FDelegateHandle SessionUserInviteAcceptedDelegateHandle;
 
-	// SESSION STATE
-	// Soon will be deprecated
+	// OPERATIONS
 	// ------------------------
-	bool bCreateSessionOnDestroy{false};
-	int32 LastNumPublicConnections;
-	FString LastMatchType;
+	FLobbyOperationScheduler Scheduler;
+
+	/** Registers the completion delegate matching the operation type */
+	void BindOperationDelegate(FLobbyOperation& Operation);
+
+	/** Clears the completion delegate registered by BindOperationDelegate */
+	void ClearOperationDelegate(FLobbyOperation& Operation);
+
+	/** Stops the backend work of an operation that timed out or was cancelled, where the interface allows it */
+	void AbortOperation(FLobbyOperation& Operation);
+
+	/** Times out operations the backend never answered */
+	void ExpireOperations();
+	FTimerHandle OperationTimeoutTimer;
+
+	// The backend runs one search at a time, so a search that was given up on still blocks the next one
+	struct FAbandonedSearch
+	{
+		bool bIsPending{false};
+		double AbandonedTime{0.0};
+		FDelegateHandle CompleteHandle;
+		FDelegateHandle CancelHandle;
+
+		/** Search held back until the abandoned one reports back */
+		FLobbyOperationId DeferredOperationId{INVALID_LOBBY_OPERATION};
+		TFunction<bool(FLobbyOperation&)> DeferredStart;
+	};
+	FAbandonedSearch AbandonedSearch;
+
+	/** Hold back the start of a search while an abandoned one is still outstanding on the backend */
+	void DeferSearchStart(FLobbyOperation& Operation);
+
+	/** The abandoned search finished or was cancelled, start the deferred search on the next tick */
+	void OnAbandonedSearchComplete(bool bWasSuccessful);
+	void ResolveAbandonedSearch();
+	void StartDeferredSearch();
+
+	/** Queue a destroy that is skipped if the session no longer exists once it runs */
+	FLobbyOperationId ScheduleSessionCleanup(FName SessionName,
+	                                         TFunction<void(const FLobbyOperation&)> OnComplete = nullptr);
 
 	// LOBBY STATE
 	// ------------------------
-	// Initialization state
-	bool bIsInitializing = false;
-	bool bInitializationComplete = false;
-
-	bool bHasPendingLobbyCreation{false};
-	FLobbySettings PendingLobbySettings;
-	bool bIsLobbyOperation{false};
-	bool bIsLobbySearch{false};
-	bool bIsLobbyJoin{false};
+	// Changes waiting for the end of the update window
+	struct FPendingLobbyUpdate
+	{
+		bool bHasSettings{false};
+		FLobbySettings Settings;
+
+		/** Membership changed, the DataVersion needs a bump even if no setting did */
+		bool bBumpDataVersion{false};
+
+		FTimerHandle FlushTimer;
+	};
+	FPendingLobbyUpdate PendingLobbyUpdate;
+
+	/** Start the update window if it is not running, or flush at once if there is none */
+	void ScheduleLobbySettingsFlush();
+
+	/** Queue the pending changes as one update */
+	void FlushLobbySettingsUpdate();
+
+	ELobbyLifecycleState LobbyLifecycleState{ELobbyLifecycleState::Lobby};
+
+	/** Broadcasts MultiplayerOnLobbyLifecycleChanged if the state actually changes */
+	void SetLobbyLifecycleState(ELobbyLifecycleState NewState);
+
+	/** Open or close the lobby to searches, presence and join in progress in one session update */
+	void UpdateLobbyJoinability(bool bJoinable);
+
+	// How the lobby was open before a match closed it, a reopen restores exactly that
+	struct FLobbyJoinability
+	{
+		bool bIsSet{false};
+		bool bShouldAdvertise{false};
+		bool bAllowJoinInProgress{false};
+		bool bAllowJoinViaPresence{false};
+	};
+	FLobbyJoinability OpenLobbyJoinability;
+
 	TMap<FString, FString> PendingKicks; // PlayerId -> Reason
 	TMap<FString, FLobbyPlayerInfo> PendingKickInfo; // PlayerId -> PlayerInfo (cached before removal)
 
-	// Pending search after stale session cleanup
-	bool bHasPendingSearch{false};
-	int32 PendingSearchMaxResults{100};
-
 	// UTILITY FUNCTIONS
 	void PrintDebugMessage(const FString& Message, bool isError);
 
@@ -222,9 +764,67 @@ private:
 	// ------------------------
 	FString HashPassword(const FString& Password) const;
 	bool ValidatePassword(const FString& Password, const FString& StoredHash) const;
-	FLobbyInfo CreateLobbyInfoFromSession() const;
-	FLobbyInfo ConvertSearchResultToLobbyInfo(const FOnlineSessionSearchResult& SearchResult) const;
+	FLobbyInfo CreateLobbyInfoFromSession(FName SessionName = NAME_GameSession) const;
+
+	/** Host only, republish the session with a new DataVersion after a membership change, within the update window */
+	void BumpLobbyDataVersion();
+
+	/**
+	 * Look up a single lobby by session id and add it to the search cache.
+	 * OnResolved gets the lobby, or nullptr if it could not be found.
+	 */
+	void ResolveLobbyById(const FString& LobbyId, TFunction<void(const FLobbyInfo*)> OnResolved);
+
+	/** Queue the join of a resolved search result, the result is reported through FinishLobbyJoin */
+	void JoinSearchResult(const FOnlineSessionSearchResult& SearchResult, const FString& LobbyId);
+
+	/** Join a party from an accepted invite, reported through MultiplayerOnPartyJoinComplete */
+	void JoinParty(const FOnlineSessionSearchResult& SearchResult);
+
+	/** Report a lobby join result, a failed quick join attempt moves on to the next candidate instead */
+	void FinishLobbyJoin(ELobbyJoinResult Result);
+
+	/** Internal method to perform lobby search after cleanup, returns false if the search could not start */
+	bool PerformFindLobbies(int32 MaxResult, const FLobbySearchFilter& Filter);
+
+	// Hidden session created by PrepareLobby
+	struct FPreparedLobby
+	{
+		/** Create queued or done, not yet published or dropped */
+		bool bIsActive{false};
+	};
+	FPreparedLobby PreparedLobby;
+
+	/** Switch the prepared session to the host's settings, advertise it and open it to presence joins and invites */
+	void PublishPreparedLobby(const FLobbySettings& LobbySettings);
+
+	/** Session settings of a lobby, bAdvertise false for a prepared session */
+	TSharedPtr<FOnlineSessionSettings> MakeLobbySessionSettings(const FLobbySettings& LobbySettings,
+	                                                            const FString& HostName,
+	                                                            bool bAdvertise) const;
+
+	/** Nickname of the local player, or DedicatedServerName (the machine name if empty) without one */
+	FString GetLobbyHostName(const ULocalPlayer* LocalPlayer) const;
+
+	/** Create a session owned by the local player, or by the server itself on a dedicated server */
+	bool CreateHostedSession(FName SessionName, const FOnlineSessionSettings& Settings);
+
+	/** Queue a cleanup of a game session we joined but do not host or only prepared, INVALID_LOBBY_OPERATION if there is none */
+	FLobbyOperationId ScheduleStaleSessionCleanup();
+
+	/** Broadcast a lobby search result, both in full and as a diff against the previous one. Returns true if anything changed. */
+	bool BroadcastLobbyList(const TArray<FLobbyInfo>& Lobbies, bool bWasSuccessful);
+
+	/** Filter, convert and cache the results of the last lobby search */
+	void CollectSearchResults(const FLobbySearchFilter& Filter, TArray<FLobbyInfo>& OutLobbies);
+
+	// Paged search helpers
+	int32 EnqueuePagedLobbies(const TArray<FLobbyInfo>& Lobbies);
+	void PumpPagedSearch();
+	void HandlePagedSearchComplete(bool bWasSuccessful, uint32 Generation);
 
-	/** Internal method to perform lobby search after cleanup */
-	void PerformFindLobbies(int32 MaxResult);
+	/** Lobby specific completion handling, run by the owning operations */
+	void HandleLobbySearchComplete(bool bWasSuccessful, const FLobbySearchFilter& Filter);
+	void HandleLobbyJoinComplete(EOnJoinSessionCompleteResult::Type Result, const FString& LobbyId,
+	                             bool bTimedOut = false);
 };
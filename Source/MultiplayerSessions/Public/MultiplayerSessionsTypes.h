@@ -8,7 +8,8 @@ UENUM(BlueprintType)
 enum class ELobbyJoinResult : uint8
 {
 	Success, LobbyFull, WrongPassword,
-	LobbyNotFound, ConnectionFailed, UnknownError
+	LobbyNotFound, ConnectionFailed, UnknownError,
+	TimedOut, MatchInProgress
 };
 
 UENUM(BlueprintType)
@@ -18,6 +19,13 @@ enum class ELobbyLeaveReason: uint8
 	SessionDestroyed, HostMigration, Unknown
 };
 
+/** Where a hosted lobby is in its match, only Lobby is advertised and joinable */
+UENUM(BlueprintType)
+enum class ELobbyLifecycleState : uint8
+{
+	Lobby, Starting, InGame, PostGame
+};
+
 USTRUCT(BlueprintType)
 struct MULTIPLAYERSESSIONS_API FLobbyInfo
 {
@@ -29,6 +37,10 @@ struct MULTIPLAYERSESSIONS_API FLobbyInfo
 	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
 	FString HostName;
 
+	/** Net id of the owning player as a string, unlike HostName unique to the host, empty if unknown */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	FString HostId;
+
 	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
 	int32 CurrentPlayerCount;
 
@@ -41,12 +53,78 @@ struct MULTIPLAYERSESSIONS_API FLobbyInfo
 	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
 	int32 PingInMs;
 
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	FString GameMode;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	FString Region;
+
+	/** Network version of the host build, 0 if the host did not advertise one */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	int32 BuildVersion;
+
+	/** Bumped by the host whenever settings or membership change, 0 if unknown */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	int32 DataVersion;
+
+	/** Hosted by or joined by a friend of the local player, listed first */
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	bool bIsFriendLobby;
+
 	FLobbyInfo() :
 		CurrentPlayerCount(0),
 		MaxPlayerCount(0),
 		bIsPublic(true),
-		PingInMs(-1)
+		PingInMs(-1),
+		BuildVersion(0),
+		DataVersion(0),
+		bIsFriendLobby(false)
+	{
+	}
+
+	/** Whether Other shows anything different for the same lobby */
+	bool DiffersFrom(const FLobbyInfo& Other) const
 	{
+		if (CurrentPlayerCount != Other.CurrentPlayerCount ||
+			MaxPlayerCount != Other.MaxPlayerCount ||
+			PingInMs != Other.PingInMs ||
+			bIsFriendLobby != Other.bIsFriendLobby)
+		{
+			return true;
+		}
+
+		// Matching host stamps mean the metadata is identical
+		if (DataVersion > 0 && DataVersion == Other.DataVersion)
+		{
+			return false;
+		}
+
+		return HostName != Other.HostName ||
+			bIsPublic != Other.bIsPublic ||
+			GameMode != Other.GameMode ||
+			Region != Other.Region ||
+			BuildVersion != Other.BuildVersion;
+	}
+};
+
+/** Change of the lobby list between two searches, keyed by LobbyId */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FLobbyListDiff
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	TArray<FLobbyInfo> Added;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	TArray<FString> RemovedLobbyIds;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lobby")
+	TArray<FLobbyInfo> Changed;
+
+	bool IsEmpty() const
+	{
+		return Added.Num() == 0 && RemovedLobbyIds.Num() == 0 && Changed.Num() == 0;
 	}
 };
 
@@ -64,6 +142,12 @@ struct MULTIPLAYERSESSIONS_API FLobbySettings
 	UPROPERTY(BlueprintReadWrite, Category = "Lobby")
 	FString Password;
 
+	UPROPERTY(BlueprintReadWrite, Category = "Lobby")
+	FString GameMode;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Lobby")
+	FString Region;
+
 	FLobbySettings() :
 		MaxPlayers(10),
 		bIsPublic(true)
@@ -71,6 +155,219 @@ struct MULTIPLAYERSESSIONS_API FLobbySettings
 	}
 };
 
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FLobbySearchFilter
+{
+	GENERATED_BODY()
+
+	/** Only lobbies with at least one open slot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	bool bOnlyNotFull;
+
+	/** Only lobbies without a password */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	bool bOnlyPublic;
+
+	/** Lobby capacity bounds (max player count), 0 means unbounded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MinLobbySize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MaxLobbySize;
+
+	/** Exact attribute matches, empty means any */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FString GameMode;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FString Region;
+
+	/** Host network version (usually the local one), 0 means any. Lobbies not advertising one pass. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 BuildVersion;
+
+	FLobbySearchFilter() :
+		bOnlyNotFull(false),
+		bOnlyPublic(false),
+		MinLobbySize(0),
+		MaxLobbySize(0),
+		BuildVersion(0)
+	{
+	}
+
+	/** Client-side check, for lobbies the backend could not filter */
+	bool Matches(const FLobbyInfo& Lobby) const
+	{
+		if (bOnlyNotFull && Lobby.CurrentPlayerCount >= Lobby.MaxPlayerCount)
+		{
+			return false;
+		}
+		if (bOnlyPublic && !Lobby.bIsPublic)
+		{
+			return false;
+		}
+		if (MinLobbySize > 0 && Lobby.MaxPlayerCount < MinLobbySize)
+		{
+			return false;
+		}
+		if (MaxLobbySize > 0 && Lobby.MaxPlayerCount > MaxLobbySize)
+		{
+			return false;
+		}
+		if (!GameMode.IsEmpty() && Lobby.GameMode != GameMode)
+		{
+			return false;
+		}
+		if (!Region.IsEmpty() && Lobby.Region != Region)
+		{
+			return false;
+		}
+		if (BuildVersion != 0 && Lobby.BuildVersion != 0 && Lobby.BuildVersion != BuildVersion)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool operator==(const FLobbySearchFilter& Other) const
+	{
+		return bOnlyNotFull == Other.bOnlyNotFull &&
+			bOnlyPublic == Other.bOnlyPublic &&
+			MinLobbySize == Other.MinLobbySize &&
+			MaxLobbySize == Other.MaxLobbySize &&
+			GameMode == Other.GameMode &&
+			Region == Other.Region &&
+			BuildVersion == Other.BuildVersion;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FQuickJoinPolicy
+{
+	GENERATED_BODY()
+
+	/** Quick join always adds not full and public only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FLobbySearchFilter Filter;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MaxSearchResults;
+
+	/** Best ranked lobbies tried before giving up */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MaxJoinAttempts;
+
+	/** Lobbies with a higher known ping are skipped, 0 means no limit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MaxPingInMs;
+
+	/** Skip lobbies hosted on a different network version */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	bool bRequireSameBuild;
+
+	/** Empty means no preference */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FString PreferredGameMode;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FString PreferredRegion;
+
+	/** Score weights, see Score */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	float PingWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	float FillWeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	float AttributeWeight;
+
+	FQuickJoinPolicy() :
+		MaxSearchResults(50),
+		MaxJoinAttempts(3),
+		MaxPingInMs(0),
+		bRequireSameBuild(true),
+		PingWeight(1.f),
+		FillWeight(0.5f),
+		AttributeWeight(0.5f)
+	{
+		Filter.bOnlyNotFull = true;
+		Filter.bOnlyPublic = true;
+	}
+
+	/** Whether a lobby may be tried at all, LocalBuildVersion is the joining client's network version */
+	bool IsEligible(const FLobbyInfo& Lobby, int32 LocalBuildVersion) const
+	{
+		if (!Filter.Matches(Lobby) || !Lobby.bIsPublic || Lobby.CurrentPlayerCount >= Lobby.MaxPlayerCount)
+		{
+			return false;
+		}
+		if (MaxPingInMs > 0 && Lobby.PingInMs > MaxPingInMs)
+		{
+			return false;
+		}
+		// Lobbies that do not advertise a build version are given the benefit of the doubt
+		if (bRequireSameBuild && Lobby.BuildVersion != 0 && Lobby.BuildVersion != LocalBuildVersion)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	/** Higher is better. Low ping, fuller lobbies (sooner to start) and preferred attributes all add to it. */
+	float Score(const FLobbyInfo& Lobby) const
+	{
+		// Unknown ping counts as average
+		const float PingScore = Lobby.PingInMs < 0 ? 0.5f : 1.f - FMath::Min(Lobby.PingInMs, 500) / 500.f;
+		const float FillScore = Lobby.MaxPlayerCount > 0
+			                        ? static_cast<float>(Lobby.CurrentPlayerCount) / Lobby.MaxPlayerCount
+			                        : 0.f;
+
+		float AttributeScore = 0.f;
+		if (!PreferredGameMode.IsEmpty() && Lobby.GameMode == PreferredGameMode)
+		{
+			AttributeScore += 0.5f;
+		}
+		if (!PreferredRegion.IsEmpty() && Lobby.Region == PreferredRegion)
+		{
+			AttributeScore += 0.5f;
+		}
+
+		return PingWeight * PingScore + FillWeight * FillScore + AttributeWeight * AttributeScore;
+	}
+};
+
+/**
+ * Several narrow searches run one after another and merged into one list, for when a
+ * single broad search would fill MaxSearchResults with lobbies nobody wants.
+ */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FLobbySearchPlan
+{
+	GENERATED_BODY()
+
+	/** Run in order, most wanted first */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	TArray<FLobbySearchFilter> Queries;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 MaxResultsPerQuery;
+
+	/** Remaining queries are skipped once this many lobbies are eligible under Ranking, 0 runs them all */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	int32 EnoughCandidates;
+
+	/** Orders the merged list, eligible lobbies first and then by score */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lobby")
+	FQuickJoinPolicy Ranking;
+
+	FLobbySearchPlan() :
+		MaxResultsPerQuery(50),
+		EnoughCandidates(10)
+	{
+	}
+};
+
 USTRUCT(BlueprintType)
 struct MULTIPLAYERSESSIONS_API FLobbyPlayerInfo
 {